@@ -57,3 +57,16 @@ for f in data/con_*.txt; do
 	
 	echo
 done
+
+# Rooted trees (LCA, evert and find-root queries), generated by generate_data.sh
+for f in data/lca_*.txt data/evert_*.txt; do
+	[ -f "$f" ] || continue
+	echo "### Input file: $f ###"
+	
+	bench ./stt-cpp/bin/mtr_stt "MTR-STT C++ optimized"
+	bench ./stt-cpp/bin/greedy_stt "Greedy SplayTT C++ optimized"
+	bench ./stt-cpp/bin/ltp_stt "LTP SplayTT C++ optimized"
+	bench ./dtree/dtree_queries "dtree link-cut"
+	
+	echo
+done
@@ -4,6 +4,7 @@ echo "Building executables..."
 (cd stt-cpp && make --silent bin/mtr_stt)
 (cd stt-cpp && make --silent bin/greedy_stt)
 (cd stt-cpp && make --silent bin/ltp_stt)
+(cd stt-cpp && make --silent bin/api_check)
 (cd dtree && make --silent)
 
 (cd stt-rs && ./build_bench.sh -q)
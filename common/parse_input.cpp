@@ -3,10 +3,13 @@
 #include <cassert>
 #include <cstdio>
 
+#include <algorithm>
 #include <chrono>
 #include <fstream>
 #include <iostream>
+#include <set>
 #include <sstream>
+#include <utility>
 #include <vector>
 
 Query::Query( QueryType type, long arg1, long arg2, long arg3 ) : type( type ), arg1( arg1 ), arg2( arg2 ), arg3( arg3 ) {}
@@ -67,6 +70,12 @@ bool read_query_file( const char* filename, size_t& num_vertices, std::vector<Qu
 		else if( sscanf( line.c_str(), "p %ld %ld", &arg1, &arg2 ) == 2 ) {
 			queries.push_back( Query( PATH, arg1, arg2 ) );
 		}
+		else if( sscanf( line.c_str(), "e %ld", &arg1 ) == 1 ) {
+			queries.push_back( Query( EVERT, arg1 ) );
+		}
+		else if( sscanf( line.c_str(), "r %ld", &arg1 ) == 1 ) {
+			queries.push_back( Query( FIND_ROOT, arg1 ) );
+		}
 		else {
 			std::cerr << "ERROR: Cannot parse line '" << line << "'\n";
 			return false;
@@ -74,3 +83,282 @@ bool read_query_file( const char* filename, size_t& num_vertices, std::vector<Qu
 	}
 	return true;
 }
+
+bool has_rooted_queries( const std::vector<Query>& queries ) {
+	for( const auto& query : queries ) {
+		if( query.type == CUT_FROM_PARENT || query.type == LCA || query.type == EVERT || query.type == FIND_ROOT ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void write_query_file( std::ostream& out, size_t num_vertices, const std::vector<Query>& queries ) {
+	out << ( has_rooted_queries( queries ) ? "lca " : "con " ) << num_vertices << " " << queries.size() << "\n";
+	for( const auto& query : queries ) {
+		switch( query.type ) {
+			case LINK : out << "i " << query.arg1 << " " << query.arg2 << "\n"; break;
+			case CUT : out << "d " << query.arg1 << " " << query.arg2 << "\n"; break;
+			case CUT_FROM_PARENT : out << "d " << query.arg1 << "\n"; break;
+			case LCA : out << "a " << query.arg1 << " " << query.arg2 << "\n"; break;
+			case PATH : out << "p " << query.arg1 << " " << query.arg2 << "\n"; break;
+			case EVERT : out << "e " << query.arg1 << "\n"; break;
+			case FIND_ROOT : out << "r " << query.arg1 << "\n"; break;
+		}
+	}
+}
+
+bool parse_vertex_order( const std::string& name, VertexOrder& order ) {
+	if( name == "bfs" ) { order = BFS_ORDER; }
+	else if( name == "dfs" ) { order = DFS_ORDER; }
+	else if( name == "first-touch" ) { order = FIRST_TOUCH_ORDER; }
+	else { return false; }
+	return true;
+}
+
+// Adjacency lists of the forest after executing all link and cut queries
+static std::vector<std::vector<long>> final_forest( size_t num_vertices, const std::vector<Query>& queries ) {
+	std::set<std::pair<long, long>> edges;
+	std::vector<long> parent( num_vertices, -1 ); // Only used by rooted queries
+	for( const auto& query : queries ) {
+		if( query.type == LINK ) {
+			edges.insert( std::minmax( query.arg1, query.arg2 ) );
+			parent[query.arg1] = query.arg2;
+		}
+		else if( query.type == CUT ) {
+			edges.erase( std::minmax( query.arg1, query.arg2 ) );
+		}
+		else if( query.type == CUT_FROM_PARENT ) {
+			edges.erase( std::minmax( query.arg1, parent[query.arg1] ) );
+			parent[query.arg1] = -1;
+		}
+		else if( query.type == EVERT ) {
+			// Reverse the path to the root
+			long prev = -1;
+			for( long v = query.arg1; v >= 0; ) {
+				const long next = parent[v];
+				parent[v] = prev;
+				prev = v;
+				v = next;
+			}
+		}
+	}
+	
+	std::vector<std::vector<long>> adj( num_vertices );
+	for( const auto& e : edges ) {
+		adj[e.first].push_back( e.second );
+		adj[e.second].push_back( e.first );
+	}
+	return adj;
+}
+
+std::vector<long> compute_relabeling( size_t num_vertices, const std::vector<Query>& queries, VertexOrder order, std::vector<long>* old_labels ) {
+	std::vector<long> new_labels( num_vertices, -1 );
+	long next_label = 0;
+	
+	if( order == FIRST_TOUCH_ORDER ) {
+		for( const auto& query : queries ) {
+			for( long v : { query.arg1, query.arg2 } ) {
+				if( v >= 0 && new_labels[v] < 0 ) {
+					new_labels[v] = next_label++;
+				}
+			}
+		}
+	}
+	else {
+		std::vector<std::vector<long>> adj = final_forest( num_vertices, queries );
+		std::vector<long> todo; // Queue (BFS) or stack (DFS)
+		for( size_t r = 0; r < num_vertices; r++ ) {
+			if( new_labels[r] >= 0 ) {
+				continue;
+			}
+			todo.assign( 1, r );
+			size_t head = 0;
+			while( head < todo.size() ) {
+				long v;
+				if( order == BFS_ORDER ) {
+					v = todo[head++];
+				}
+				else {
+					v = todo.back();
+					todo.pop_back();
+				}
+				if( new_labels[v] >= 0 ) {
+					continue;
+				}
+				new_labels[v] = next_label++;
+				for( long w : adj[v] ) {
+					if( new_labels[w] < 0 ) {
+						todo.push_back( w );
+					}
+				}
+			}
+		}
+	}
+	
+	for( size_t v = 0; v < num_vertices; v++ ) {
+		if( new_labels[v] < 0 ) {
+			new_labels[v] = next_label++;
+		}
+	}
+	if( old_labels != nullptr ) {
+		old_labels->assign( num_vertices, -1 );
+		for( size_t v = 0; v < num_vertices; v++ ) {
+			(*old_labels)[new_labels[v]] = v;
+		}
+	}
+	return new_labels;
+}
+
+void relabel_queries( std::vector<Query>& queries, const std::vector<long>& new_labels ) {
+	for( auto& query : queries ) {
+		query.arg1 = new_labels[query.arg1];
+		if( query.arg2 >= 0 ) {
+			query.arg2 = new_labels[query.arg2];
+		}
+	}
+}
+
+
+void print_bench_result( size_t num_vertices, size_t num_queries, size_t repeat, bool json, const char* algo_name, long duration_us, long total_yes ) {
+	if( json ) {
+		std::cout << "{\"num_vertices\":" << num_vertices << ",\"num_queries\":" << num_queries << ",\"name\":\"" << algo_name << "\",\"time_ns\":" << duration_us * 1000 / repeat << "}" << std::endl;
+	}
+	else {
+		std::cout << "Total yes-anwers: " << total_yes / repeat << "\n";
+//		std::cout << "Rotations: " << num_rotations / repeat << "/run – " << num_rotations / repeat / num_queries << "/query\n";
+		std::cout << duration_us << " us total\n";
+		std::cout << duration_us / repeat << " us/run\n";
+		std::cout << duration_us * 1. / repeat / num_queries << " us/query\n";
+	}
+}
+
+
+int main_connectivity( int argc, const char** argv, const std::vector<NamedImpl>& impls, OptionHandler handle_option ) {
+	assert( !impls.empty() );
+	
+	// Consume options preceding the command
+	std::vector<const char*> args( 1, argv[0] );
+	bool relabel = false;
+	VertexOrder order = BFS_ORDER;
+	std::vector<NamedImpl> selected;
+	int i = 1;
+	for( ; i < argc && std::strncmp( argv[i], "--", 2 ) == 0; i++ ) {
+		const char* relabel_prefix = "--relabel=";
+		const char* variant_prefix = "--variant=";
+		if( std::strncmp( argv[i], relabel_prefix, std::strlen( relabel_prefix ) ) == 0
+				&& parse_vertex_order( argv[i] + std::strlen( relabel_prefix ), order ) ) {
+			relabel = true;
+		}
+		else if( std::strncmp( argv[i], variant_prefix, std::strlen( variant_prefix ) ) == 0 ) {
+			std::string name( argv[i] + std::strlen( variant_prefix ) );
+			if( name == "all" ) {
+				selected.insert( selected.end(), impls.begin(), impls.end() );
+				continue;
+			}
+			auto it = std::find_if( impls.begin(), impls.end(), [&name]( const NamedImpl& impl ) { return impl.name == name; } );
+			if( it == impls.end() ) {
+				std::cout << "Unknown variant '" << name << "'. Available variants:";
+				for( const auto& impl : impls ) {
+					std::cout << " " << impl.name;
+				}
+				std::cout << "\n";
+				return 1;
+			}
+			selected.push_back( *it );
+		}
+		else if( handle_option == nullptr || !handle_option( argv[i] ) ) {
+			std::cout << "Unknown option '" << argv[i] << "'\n";
+			return 1;
+		}
+	}
+	args.insert( args.end(), argv + i, argv + argc );
+	argc = args.size();
+	argv = args.data();
+	
+	if( selected.empty() ) {
+		// Default implementation, reported under the name of the executable
+		selected.push_back( impls.front() );
+		selected.back().name = argv[0];
+	}
+	// Only label the output if there is more than one implementation to run
+	const bool print_names = selected.size() > 1;
+	
+	if( argc < 3 ) {
+		std::cout << "usage: " << argv[0] << " [options] <bench|compute> <...> <query-file>\n";
+		return 1;
+	}
+	
+	std::string cmd( argv[1] );
+	if( cmd == "bench" ) {
+		if( !( argc == 4 || ( argc == 5 && std::strcmp( argv[2], "--json" ) == 0 ) ) ) {
+			std::cout << "usage: " << argv[0] << " [options] bench [--json] <repeat> <query-file>\n";
+			return 1;
+		}
+		size_t repeat = std::atol( argv[argc-2] );
+		
+		bool json = ( argc == 5 );
+		
+		size_t num_vertices;
+		std::vector<Query> queries;
+		if( !read_query_file( argv[argc-1], num_vertices, queries ) ) {
+			std::cerr << "Failed parsing file' " << argv[argc-1] << "'\n";
+			return 2;
+		}
+		if( relabel ) {
+			relabel_queries( queries, compute_relabeling( num_vertices, queries, order ) );
+		}
+		
+		if( !json ) {
+			std::cout << "Successfully parsed file. Now executing " << queries.size() << " queries on " << num_vertices << " vertices " << repeat << " times." << std::endl;
+		}
+		
+		const bool rooted = has_rooted_queries( queries );
+		for( const auto& impl : selected ) {
+			if( print_names && !json ) {
+				std::cout << "++ " << impl.name << " ++\n";
+			}
+			NamedImpl::BenchFn bench = rooted ? impl.bench_rooted : impl.bench;
+			if( bench == nullptr ) {
+				std::cerr << impl.name << " does not support rooted queries\n";
+				return 3;
+			}
+			if( ! bench( num_vertices, queries, repeat, json, impl.name.c_str() ) ) {
+				return 3;
+			}
+		}
+	}
+	else if( cmd == "compute" ) {
+		size_t num_vertices;
+		std::vector<Query> queries;
+		if( !read_query_file( argv[2], num_vertices, queries ) ) {
+			std::cerr << "Failed parsing file' " << argv[2] << "'\n";
+			return 2;
+		}
+		std::vector<long> old_labels; // Empty if not relabeled
+		if( relabel ) {
+			relabel_queries( queries, compute_relabeling( num_vertices, queries, order, &old_labels ) );
+		}
+		const bool rooted = has_rooted_queries( queries );
+		for( const auto& impl : selected ) {
+			if( print_names ) {
+				std::cout << "++ " << impl.name << " ++\n";
+			}
+			NamedImpl::ComputeFn compute = rooted ? impl.compute_rooted : impl.compute;
+			if( compute == nullptr ) {
+				std::cerr << impl.name << " does not support rooted queries\n";
+				return 3;
+			}
+			if( ! compute( num_vertices, queries, old_labels ) ) {
+				return 3;
+			}
+		}
+	}
+	else {
+		std::cout << "usage: " << argv[0] << " [options] <bench|compute> <...> <query-file>\n";
+		return 1;
+	}
+	
+	
+	return 0;
+}
@@ -2,11 +2,13 @@
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <string>
 #include <vector>
 
 #ifndef PARSE_INPUT_H
+#define PARSE_INPUT_H
 
-enum QueryType { LINK, CUT, CUT_FROM_PARENT, LCA, PATH };
+enum QueryType { LINK, CUT, CUT_FROM_PARENT, LCA, PATH, EVERT, FIND_ROOT };
 
 struct Query {
 	QueryType type;
@@ -21,6 +23,36 @@ std::ostream& operator<<( std::ostream& out, const Query& query );
 
 bool read_query_file( const char* filename, size_t& num_vertices, std::vector<Query>& queries );
 
+/// Writes queries in the format read by read_query_file.
+void write_query_file( std::ostream& out, size_t num_vertices, const std::vector<Query>& queries );
+
+
+// Vertex relabeling
+
+enum VertexOrder {
+	BFS_ORDER, // Breadth-first search of the forest after all queries
+	DFS_ORDER, // Depth-first search (preorder) of the forest after all queries
+	FIRST_TOUCH_ORDER // Order of first appearance in the queries
+};
+
+/// Parses "bfs", "dfs" or "first-touch".
+bool parse_vertex_order( const std::string& name, VertexOrder& order );
+
+/* Computes a permutation of the vertices that places vertices close together if they are close in
+ * the forest (or the queries). Returns the new label of each vertex. Vertices not covered by the
+ * order are appended in their original order. If old_labels is given, it is set to the inverse
+ * permutation, i.e., the original label of each new label. */
+std::vector<long> compute_relabeling( size_t num_vertices, const std::vector<Query>& queries, VertexOrder order, std::vector<long>* old_labels = nullptr );
+
+/// Replaces each vertex v in the queries by new_labels[v].
+void relabel_queries( std::vector<Query>& queries, const std::vector<long>& new_labels );
+
+
+/// Prints the result of a benchmark run, as plain text or as a JSON line.
+void print_bench_result( size_t num_vertices, size_t num_queries, size_t repeat, bool json, const char* algo_name, long duration_us, long total_yes );
+
+/// Whether the queries are on rooted trees, i.e., contain CUT_FROM_PARENT, LCA, EVERT or FIND_ROOT queries.
+bool has_rooted_queries( const std::vector<Query>& queries );
 
 /* Requires class with the following methods:
 void link( size_t u, size_t v );
@@ -53,21 +85,21 @@ bool bench_queries( size_t num_vertices, const std::vector<Query>& queries, size
 	}
 	
 	auto duration = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::high_resolution_clock::now() - start );
-	if( json ) {
-		std::cout << "{\"num_vertices\":" << num_vertices << ",\"num_queries\":" << queries.size() << ",\"name\":\"" << algo_name << "\",\"time_ns\":" << duration.count() * 1000 / repeat << "}" << std::endl;
-	}
-	else {
-		std::cout << "Total yes-anwers: " << total_cons / repeat << "\n";
-//		std::cout << "Rotations: " << num_rotations / repeat << "/run – " << num_rotations / repeat / queries.size() << "/query\n";
-		std::cout << duration.count() << " us total\n";
-		std::cout << duration.count() / repeat << " us/run\n";
-		std::cout << duration.count() * 1. / repeat / queries.size() << " us/query\n";
-	}
+	print_bench_result( num_vertices, queries.size(), repeat, json, algo_name, duration.count(), total_cons );
 	return true;
 }
 
+/* Original label of the vertex v, given the inverse permutation computed by compute_relabeling()
+ * (empty if the vertices were not relabeled). size_t( -1 ) is kept as -1. */
+inline long original_label( const std::vector<long>& old_labels, size_t v ) {
+	if( v == size_t( -1 ) ) {
+		return -1;
+	}
+	return old_labels.empty() ? long( v ) : old_labels[v];
+}
+
 template<typename T>
-bool compute_queries( size_t num_vertices, const std::vector<Query>& queries ) {
+bool compute_queries( size_t num_vertices, const std::vector<Query>& queries, const std::vector<long>& /* old_labels */ ) {
 	T t( num_vertices );
 	for( const auto& query : queries ) {
 		if( query.type == LINK ) {
@@ -88,56 +120,126 @@ bool compute_queries( size_t num_vertices, const std::vector<Query>& queries ) {
 	return true;
 }
 
+/* For rooted trees. Requires class with the following methods:
+void link( size_t u, size_t v ); // u must be a root, and becomes a child of v
+void cut_from_parent( size_t v );
+size_t lca( size_t u, size_t v ); // size_t( -1 ) if not connected
+bool is_connected( size_t u, size_t v );
+void evert( size_t v ); // Makes v the root of its tree
+size_t find_root( size_t v );
+*/
+
 template<typename T>
-int main_connectivity( int argc, const char** argv ) {
-	if( argc < 3 ) {
-		std::cout << "usage: " << argv[0] << " <bench|compute> <...> <query-file>\n";
-		return 1;
+bool bench_rooted_queries( size_t num_vertices, const std::vector<Query>& queries, size_t repeat, bool json, const char* algo_name ) {
+	auto start = std::chrono::high_resolution_clock::now();
+	
+	int total_yes = 0; // To avoid optimizing away path and lca queries.
+	for(size_t i = 0; i < repeat; i++ ) {
+		T t( num_vertices );
+		for( const auto& query : queries ) {
+			if( query.type == LINK ) {
+				t.link( query.arg1, query.arg2 );
+			}
+			else if( query.type == CUT_FROM_PARENT ) {
+				t.cut_from_parent( query.arg1 );
+			}
+			else if( query.type == LCA ) {
+				total_yes += ( t.lca( query.arg1, query.arg2 ) != size_t( -1 ) );
+			}
+			else if( query.type == PATH ) {
+				total_yes += t.is_connected( query.arg1, query.arg2 );
+			}
+			else if( query.type == EVERT ) {
+				t.evert( query.arg1 );
+			}
+			else if( query.type == FIND_ROOT ) {
+				total_yes += ( t.find_root( query.arg1 ) == size_t( query.arg1 ) );
+			}
+			else {
+				std::cerr << "Cannot execute query '" << query << "' on rooted trees\n";
+				return false;
+			}
+		}
 	}
 	
-	std::string cmd( argv[1] );
-	if( cmd == "bench" ) {
-		if( !( argc == 4 || ( argc == 5 && std::strcmp( argv[2], "--json" ) == 0 ) ) ) {
-			std::cout << "usage: " << argv[0] << " bench [--json] <repeat> <query-file>\n";
-			return 1;
+	auto duration = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::high_resolution_clock::now() - start );
+	print_bench_result( num_vertices, queries.size(), repeat, json, algo_name, duration.count(), total_yes );
+	return true;
+}
+
+/// Vertices in the output are translated back to their original labels (see original_label()).
+template<typename T>
+bool compute_rooted_queries( size_t num_vertices, const std::vector<Query>& queries, const std::vector<long>& old_labels ) {
+	T t( num_vertices );
+	for( const auto& query : queries ) {
+		if( query.type == LINK ) {
+			t.link( query.arg1, query.arg2 );
 		}
-		size_t repeat = std::atol( argv[argc-2] );
-		
-		bool json = ( argc == 5 );
-		
-		size_t num_vertices;
-		std::vector<Query> queries;
-		if( !read_query_file( argv[argc-1], num_vertices, queries ) ) {
-			std::cerr << "Failed parsing file' " << argv[argc-1] << "'\n";
-			return 2;
+		else if( query.type == CUT_FROM_PARENT ) {
+			t.cut_from_parent( query.arg1 );
 		}
-		
-		if( !json ) {
-			std::cout << "Successfully parsed file. Now executing " << queries.size() << " queries on " << num_vertices << " vertices " << repeat << " times." << std::endl;
+		else if( query.type == LCA ) {
+			std::cout << original_label( old_labels, t.lca( query.arg1, query.arg2 ) ) << "\n";
 		}
-		
-		if( ! bench_queries<T>( num_vertices, queries, repeat, json, argv[0] ) ) {
-			return 3;
+		else if( query.type == PATH ) {
+			std::cout << (int) t.is_connected( query.arg1, query.arg2 ) << "\n";
 		}
-	}
-	else if( cmd == "compute" ) {
-		size_t num_vertices;
-		std::vector<Query> queries;
-		if( !read_query_file( argv[2], num_vertices, queries ) ) {
-			std::cerr << "Failed parsing file' " << argv[2] << "'\n";
-			return 2;
+		else if( query.type == EVERT ) {
+			t.evert( query.arg1 );
 		}
-		if( ! compute_queries<T>( num_vertices, queries ) ) {
-			return 3;
+		else if( query.type == FIND_ROOT ) {
+			std::cout << original_label( old_labels, t.find_root( query.arg1 ) ) << "\n";
+		}
+		else {
+			std::cerr << "Cannot execute query '" << query << "' on rooted trees\n";
+			return false;
 		}
-	}
-	else {
-		std::cout << "usage: " << argv[0] << " <bench|compute> <...> <query-file>\n";
-		return 1;
 	}
 	
+	return true;
+}
+
+/* Handles an implementation-specific command line option (e.g., "--pages=thp"). Returns false if the
+ * option is unknown. */
+typedef bool (*OptionHandler)( const std::string& option );
+
+/* Implementation that can be selected by name at runtime (see main_connectivity()). The functions for
+ * rooted queries are null if the implementation does not support them. */
+struct NamedImpl {
+	typedef bool (*BenchFn)( size_t num_vertices, const std::vector<Query>& queries, size_t repeat, bool json, const char* algo_name );
+	typedef bool (*ComputeFn)( size_t num_vertices, const std::vector<Query>& queries, const std::vector<long>& old_labels );
 	
-	return 0;
+	std::string name;
+	BenchFn bench;
+	ComputeFn compute;
+	BenchFn bench_rooted;
+	ComputeFn compute_rooted;
+};
+
+template<typename T>
+NamedImpl named_impl( const std::string& name ) {
+	return NamedImpl{ name, bench_queries<T>, compute_queries<T>, nullptr, nullptr };
+}
+
+/// Implementation using T for unrooted and RootedT for rooted queries.
+template<typename T, typename RootedT>
+NamedImpl named_impl( const std::string& name ) {
+	return NamedImpl{ name, bench_queries<T>, compute_queries<T>, bench_rooted_queries<RootedT>, compute_rooted_queries<RootedT> };
+}
+
+/* Runs the command given on the command line with some of the given implementations. The first
+ * implementation is the default.
+ * Common options:
+ * --relabel=<bfs|dfs|first-touch> relabels the vertices (see compute_relabeling()) before running the
+ * queries. Vertices in the answers (e.g., of LCA queries) are translated back to the original labels.
+ * --variant=<name|all> selects the implementation to run. Can be repeated; "all" runs all
+ * implementations in turn, on the same parsed queries.
+ * Query files with CUT_FROM_PARENT or LCA queries are run as rooted queries. */
+int main_connectivity( int argc, const char** argv, const std::vector<NamedImpl>& impls, OptionHandler handle_option = nullptr );
+
+template<typename T>
+int main_connectivity( int argc, const char** argv, OptionHandler handle_option = nullptr ) {
+	return main_connectivity( argc, argv, { named_impl<T>( argv[0] ) }, handle_option );
 }
 
 #endif
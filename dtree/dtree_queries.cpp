@@ -26,8 +26,14 @@ class Forest {
   void Link(NodeId v, NodeId w) { dtree::Link(&node_[v], &node_[w]); }
   void Cut(NodeId v) { dtree::Cut(&node_[v]); }
   void Evert(NodeId v) { E::Evert(&node_[v]); }
+  // returns kNone if v and w are not connected
+  NodeId LeafmostCommonAnc(NodeId v, NodeId w) {
+    return ToId(dtree::LeafmostCommonAnc(&node_[v], &node_[w]));
+  }
+  static constexpr NodeId kNone = static_cast<NodeId>(-1);
 
  private:
+  NodeId ToId(Node* node) const { return node ? node - node_ : kNone; }
   Node* node_;
   // disallows the copy constructor and the assignment operator
   Forest(const Forest&);
@@ -136,6 +142,41 @@ private :
 	Forest lc;
 };
 
+// Rooted trees
+class DTreeRootedForest {
+public :
+	typedef size_t NodeIdx;
+	DTreeRootedForest( size_t num_nodes ) {
+		lc.Initialize( num_nodes );
+	}
+	
+	void link( NodeIdx u, NodeIdx v ) {
+		lc.Link( u, v );
+	}
+	
+	void cut_from_parent( NodeIdx v ) {
+		lc.Cut( v );
+	}
+	
+	NodeIdx lca( NodeIdx u, NodeIdx v ) {
+		return lc.LeafmostCommonAnc( u, v );
+	}
+	
+	bool is_connected( NodeIdx u, NodeIdx v ) {
+		return lc.FindRoot( u ) == lc.FindRoot( v );
+	}
+	
+	void evert( NodeIdx v ) {
+		lc.Evert( v );
+	}
+	
+	NodeIdx find_root( NodeIdx v ) {
+		return lc.FindRoot( v );
+	}
+private :
+	Forest lc;
+};
+
 int main( int argc, const char** argv ) {
-	main_connectivity<DTreeSTF>( argc, argv );
+	return main_connectivity( argc, argv, { named_impl<DTreeSTF, DTreeRootedForest>( "dtree" ) } );
 }
\ No newline at end of file
@@ -43,3 +43,23 @@ do
     done
     progress_bar_end
 done
+
+# Rooted trees, mostly with LCA queries (lca_*) or with everts and find-root queries (evert_*) (see stt-cpp/generate_rooted_queries.cpp)
+echo "Building rooted query generator..."
+(cd stt-cpp && make --silent bin/generate_rooted_queries) || exit
+ROOTED_GEN_BIN="./stt-cpp/bin/generate_rooted_queries"
+
+echo "Generating rooted data"
+for n in ${SIZES[@]}
+do
+    let q=$n*10
+	echo "n = $n, q = $q"
+    progress_bar_start
+    for ((i=0;i<REPEAT;i++))
+    do
+        $ROOTED_GEN_BIN $n $q $RANDOM > "$DATA_DIR/lca_${n}_${i}.txt" || exit
+        $ROOTED_GEN_BIN $n $q $RANDOM evert > "$DATA_DIR/evert_${n}_${i}.txt" || exit
+        progress_bar_tick
+    done
+    progress_bar_end
+done
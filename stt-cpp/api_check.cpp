@@ -0,0 +1,714 @@
+#include "greedy_stt.h"
+#include "ltp_stt.h"
+#include "mtr_stt.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/* Checks the operations of STF beyond link, cut and is_connected against a naive forest, with
+ * random operations on a small forest. Each check runs with the default access implementation of
+ * MTR, greedy and LTP splay. Prints one line per check and returns 1 if any check fails. The
+ * arguments, if any, select the checks to run by name. Run by test.sh. */
+
+namespace {
+
+const size_t NUM_VERTICES = 40;
+const size_t NUM_STEPS = 20000;
+const size_t NONE = size_t( -1 );
+
+typedef std::mt19937_64 Random;
+typedef std::pair<size_t, size_t> Edge;
+
+// Forest with adjacency lists, whose paths are found by DFS
+class NaiveForest {
+public :
+	explicit NaiveForest( size_t n ) : adj( n ) {}
+	
+	size_t size() const { return adj.size(); }
+	
+	void link( size_t u, size_t v ) {
+		adj[u].push_back( v );
+		adj[v].push_back( u );
+		edges.push_back( Edge( u, v ) );
+	}
+	
+	void cut( size_t u, size_t v ) {
+		adj[u].erase( std::find( adj[u].begin(), adj[u].end(), v ) );
+		adj[v].erase( std::find( adj[v].begin(), adj[v].end(), u ) );
+		for( Edge& e : edges ) {
+			if( e == Edge( u, v ) || e == Edge( v, u ) ) {
+				e = edges.back();
+				edges.pop_back();
+				break;
+			}
+		}
+	}
+	
+	bool is_adjacent( size_t u, size_t v ) const {
+		return std::find( adj[u].begin(), adj[u].end(), v ) != adj[u].end();
+	}
+	
+	/// The vertices on the path from u to v, or nothing if they are not connected.
+	std::vector<size_t> path( size_t u, size_t v ) const {
+		std::vector<size_t> parent( size(), NONE );
+		std::vector<size_t> stack( 1, u );
+		parent[u] = u;
+		while( !stack.empty() ) {
+			const size_t x = stack.back();
+			stack.pop_back();
+			for( size_t y : adj[x] ) {
+				if( parent[y] == NONE ) {
+					parent[y] = x;
+					stack.push_back( y );
+				}
+			}
+		}
+		std::vector<size_t> result;
+		if( parent[v] != NONE ) {
+			for( size_t x = v; x != u; x = parent[x] ) {
+				result.push_back( x );
+			}
+			result.push_back( u );
+			std::reverse( result.begin(), result.end() );
+		}
+		return result;
+	}
+	
+	bool is_connected( size_t u, size_t v ) const { return !path( u, v ).empty(); }
+	
+	size_t component_size( size_t v ) const {
+		size_t count = 0;
+		for( size_t x = 0; x < size(); x++ ) {
+			count += is_connected( v, x );
+		}
+		return count;
+	}
+	
+	std::vector<Edge> edges;
+
+private :
+	std::vector<std::vector<size_t>> adj;
+};
+
+// Forest of rooted trees, given by the parent of each vertex
+class NaiveRootedForest {
+public :
+	explicit NaiveRootedForest( size_t n ) : parent( n, NONE ) {}
+	
+	size_t size() const { return parent.size(); }
+	
+	size_t root( size_t v ) const {
+		while( parent[v] != NONE ) {
+			v = parent[v];
+		}
+		return v;
+	}
+	
+	/// v and its ancestors, from v to the root.
+	std::vector<size_t> ancestors( size_t v ) const {
+		std::vector<size_t> result( 1, v );
+		while( parent[result.back()] != NONE ) {
+			result.push_back( parent[result.back()] );
+		}
+		return result;
+	}
+	
+	size_t subtree_size( size_t v ) const {
+		size_t count = 0;
+		for( size_t x = 0; x < size(); x++ ) {
+			const std::vector<size_t> a = ancestors( x );
+			count += std::find( a.begin(), a.end(), v ) != a.end();
+		}
+		return count;
+	}
+	
+	void evert( size_t v ) {
+		size_t prev = NONE;
+		while( v != NONE ) {
+			const size_t next = parent[v];
+			parent[v] = prev;
+			prev = v;
+			v = next;
+		}
+	}
+	
+	std::vector<size_t> parent;
+};
+
+void expect( bool condition, const std::string& what ) {
+	if( !condition ) {
+		throw std::runtime_error( what );
+	}
+}
+
+/* Cuts a random edge of g (a quarter of the time) or links two random vertices if they are not
+ * connected, in g and with the given functions. */
+template<typename Link, typename Cut>
+void random_link_or_cut( NaiveForest& g, Random& rng, Link link, Cut cut ) {
+	if( rng() % 4 == 0 && !g.edges.empty() ) {
+		const Edge e = g.edges[rng() % g.edges.size()];
+		cut( e.first, e.second );
+		g.cut( e.first, e.second );
+		return;
+	}
+	const size_t u = rng() % g.size();
+	const size_t v = rng() % g.size();
+	if( u != v && !g.is_connected( u, v ) ) {
+		link( u, v );
+		g.link( u, v );
+	}
+}
+
+// random_link_or_cut() in g and the STF f
+template<typename F>
+void random_change( NaiveForest& g, F& f, Random& rng ) {
+	random_link_or_cut( g, rng, [&]( size_t a, size_t b ) { f.link( a, b ); }, [&]( size_t a, size_t b ) { f.cut( a, b ); } );
+}
+
+/* Links the root of a random vertex u to another random vertex if they are not connected, and
+ * otherwise cuts u from its parent or makes it the root of its tree, in g and in the RootedSTF f. */
+template<typename F>
+void random_rooted_change( NaiveRootedForest& g, F& f, Random& rng ) {
+	const size_t u = rng() % g.size();
+	const size_t v = rng() % g.size();
+	const size_t r = g.root( u );
+	if( r != g.root( v ) ) {
+		f.link( r, v );
+		g.parent[r] = v;
+	}
+	else if( rng() % 2 == 0 && g.parent[u] != NONE ) {
+		f.cut_from_parent( u );
+		g.parent[u] = NONE;
+	}
+	else {
+		f.evert( u );
+		g.evert( u );
+	}
+}
+
+/* Random forest, where vertex i > 0 is a child of a smaller vertex (the second vertex of its
+ * edge) with probability 3/4. The edges are in random order. */
+std::vector<Edge> random_forest( size_t n, Random& rng ) {
+	std::vector<Edge> edges;
+	for( size_t i = 1; i < n; i++ ) {
+		if( rng() % 4 != 0 ) {
+			edges.push_back( Edge( i, rng() % i ) );
+		}
+	}
+	std::shuffle( edges.begin(), edges.end(), rng );
+	return edges;
+}
+
+// Whether f.build( edges ) throws std::invalid_argument
+template<typename F>
+bool build_throws( F& f, const std::vector<Edge>& edges ) {
+	try {
+		f.build( edges );
+	}
+	catch( const std::invalid_argument& ) {
+		return true;
+	}
+	return false;
+}
+
+// Random access weights for STF::rebuild()
+std::vector<double> random_access_weights( size_t n, Random& rng ) {
+	std::vector<double> weights( n );
+	for( double& w : weights ) {
+		w = double( rng() % 10 );
+	}
+	return weights;
+}
+
+/// link() with weights, edge_weight() and path_max_edge(), also after rebuild().
+template<typename AccessImpl>
+void check_edge_weights( Random& rng ) {
+	typedef stt::EdgeAggregateNode<stt::MaxAggregate<long>> N;
+	stt::STF<AccessImpl, stt::ArenaStorage<N>, stt::MaintainedOptions> f( NUM_VERTICES );
+	NaiveForest g( NUM_VERTICES );
+	std::map<Edge, long> weight;
+	for( size_t step = 0; step < NUM_STEPS; step++ ) {
+		const size_t u = rng() % NUM_VERTICES;
+		const size_t v = rng() % NUM_VERTICES;
+		switch( rng() % 8 ) {
+			case 0 :
+			case 1 :
+			case 2 :
+				random_link_or_cut( g, rng, [&]( size_t a, size_t b ) {
+					const long w = long( rng() % 1000 ) - 500;
+					f.link( a, b, w );
+					weight[Edge( a, b )] = weight[Edge( b, a )] = w;
+				}, [&]( size_t a, size_t b ) { f.cut( a, b ); } );
+				break;
+			case 3 :
+				if( !g.edges.empty() ) {
+					const Edge e = g.edges[rng() % g.edges.size()];
+					expect( f.edge_weight( e.second, e.first ) == weight[e], "edge_weight() of an edge" );
+				}
+				break;
+			case 4 :
+				if( !g.is_adjacent( u, v ) ) {
+					bool thrown = false;
+					try {
+						f.edge_weight( u, v );
+					}
+					catch( const std::invalid_argument& ) {
+						thrown = true;
+					}
+					expect( thrown, "edge_weight() of non-adjacent vertices must throw" );
+				}
+				break;
+			case 5 :
+				f.rebuild( u, random_access_weights( NUM_VERTICES, rng ) );
+				break;
+			default : {
+				const std::vector<size_t> path = g.path( u, v );
+				long max = stt::MaxAggregate<long>::identity();
+				for( size_t i = 1; i < path.size(); i++ ) {
+					max = std::max( max, weight[Edge( path[i - 1], path[i] )] );
+				}
+				expect( f.path_max_edge( u, v ) == max, "path_max_edge()" );
+			}
+		}
+	}
+}
+
+/// path_add(), path_sum() and path_min(), with set_weight() in between.
+template<typename AccessImpl>
+void check_path_add( Random& rng ) {
+	stt::STF<AccessImpl, stt::ArenaStorage<stt::AddNode<long>>> f( NUM_VERTICES );
+	NaiveForest g( NUM_VERTICES );
+	std::vector<long> weight( NUM_VERTICES, 0 );
+	for( size_t step = 0; step < NUM_STEPS; step++ ) {
+		const size_t u = rng() % NUM_VERTICES;
+		const size_t v = rng() % NUM_VERTICES;
+		const std::vector<size_t> path = g.path( u, v );
+		switch( rng() % 8 ) {
+			case 0 :
+			case 1 :
+				random_link_or_cut( g, rng, [&]( size_t a, size_t b ) { f.link( a, b ); }, [&]( size_t a, size_t b ) { f.cut( a, b ); } );
+				break;
+			case 2 :
+				weight[v] = long( rng() % 1000 ) - 500;
+				f.set_weight( v, weight[v] );
+				break;
+			case 3 :
+			case 4 : {
+				const long delta = long( rng() % 100 ) - 50;
+				f.path_add( u, v, delta );
+				for( size_t x : path ) {
+					weight[x] += delta;
+				}
+				break;
+			}
+			case 5 :
+				expect( f.get_weight( v ) == weight[v], "get_weight() after path_add()" );
+				break;
+			default : {
+				long sum = 0;
+				long min = std::numeric_limits<long>::max();
+				for( size_t x : path ) {
+					sum += weight[x];
+					min = std::min( min, weight[x] );
+				}
+				expect( f.path_sum( u, v ) == sum, "path_sum()" );
+				expect( f.path_min( u, v ) == min, "path_min()" );
+			}
+		}
+	}
+}
+
+/// component_size(), and subtree_size() and parent() in RootedSTF.
+template<typename AccessImpl>
+void check_sizes( Random& rng ) {
+	stt::STF<AccessImpl, stt::ArenaStorage<stt::SizeNode>> f( NUM_VERTICES );
+	NaiveForest g( NUM_VERTICES );
+	for( size_t step = 0; step < NUM_STEPS / 4; step++ ) {
+		const size_t v = rng() % NUM_VERTICES;
+		if( rng() % 2 == 0 ) {
+			random_link_or_cut( g, rng, [&]( size_t a, size_t b ) { f.link( a, b ); }, [&]( size_t a, size_t b ) { f.cut( a, b ); } );
+		}
+		else {
+			expect( f.component_size( v ) == g.component_size( v ), "component_size()" );
+		}
+	}
+	
+	stt::RootedSTF<AccessImpl, stt::ArenaStorage<stt::SizeNode>> rf( NUM_VERTICES );
+	NaiveRootedForest rg( NUM_VERTICES );
+	for( size_t step = 0; step < NUM_STEPS / 4; step++ ) {
+		const size_t v = rng() % NUM_VERTICES;
+		switch( rng() % 4 ) {
+			case 0 :
+				random_rooted_change( rg, rf, rng );
+				break;
+			case 1 :
+				expect( rf.parent( v ) == rg.parent[v], "parent()" );
+				break;
+			case 2 :
+				expect( rf.component_size( v ) == rg.subtree_size( rg.root( v ) ), "component_size() in RootedSTF" );
+				break;
+			default :
+				expect( rf.subtree_size( v ) == rg.subtree_size( v ), "subtree_size()" );
+		}
+	}
+}
+
+/// distance() between random vertices.
+template<typename AccessImpl>
+void check_distance( Random& rng ) {
+	stt::STF<AccessImpl, stt::ArenaStorage<stt::SizeNode>> f( NUM_VERTICES );
+	NaiveForest g( NUM_VERTICES );
+	for( size_t step = 0; step < NUM_STEPS; step++ ) {
+		const size_t u = rng() % NUM_VERTICES;
+		const size_t v = rng() % NUM_VERTICES;
+		if( rng() % 2 == 0 ) {
+			random_link_or_cut( g, rng, [&]( size_t a, size_t b ) { f.link( a, b ); }, [&]( size_t a, size_t b ) { f.cut( a, b ); } );
+		}
+		else {
+			const std::vector<size_t> path = g.path( u, v );
+			expect( f.distance( u, v ) == ( path.empty() ? NONE : path.size() - 1 ), "distance()" );
+		}
+	}
+}
+
+/// kth_on_path(), and ancestor() in RootedSTF.
+template<typename AccessImpl>
+void check_kth( Random& rng ) {
+	stt::STF<AccessImpl, stt::ArenaStorage<stt::SizeNode>> f( NUM_VERTICES );
+	NaiveForest g( NUM_VERTICES );
+	for( size_t step = 0; step < NUM_STEPS / 2; step++ ) {
+		const size_t u = rng() % NUM_VERTICES;
+		const size_t v = rng() % NUM_VERTICES;
+		if( rng() % 2 == 0 ) {
+			random_link_or_cut( g, rng, [&]( size_t a, size_t b ) { f.link( a, b ); }, [&]( size_t a, size_t b ) { f.cut( a, b ); } );
+		}
+		else {
+			const std::vector<size_t> path = g.path( u, v );
+			const size_t k = rng() % ( path.size() + 2 );
+			expect( f.kth_on_path( u, v, k ) == ( k < path.size() ? path[k] : NONE ), "kth_on_path()" );
+		}
+	}
+	
+	stt::RootedSTF<AccessImpl, stt::ArenaStorage<stt::SizeNode>> rf( NUM_VERTICES );
+	NaiveRootedForest rg( NUM_VERTICES );
+	for( size_t step = 0; step < NUM_STEPS / 2; step++ ) {
+		const size_t v = rng() % NUM_VERTICES;
+		if( rng() % 2 == 0 ) {
+			random_rooted_change( rg, rf, rng );
+		}
+		else {
+			const std::vector<size_t> a = rg.ancestors( v );
+			const size_t k = rng() % ( a.size() + 2 );
+			expect( rf.ancestor( v, k ) == ( k < a.size() ? a[k] : NONE ), "ancestor()" );
+		}
+	}
+}
+
+/* nearest_marked(), which may return any marked vertex with the smallest distance, and
+ * nearest_marked_ancestor() in RootedSTF. */
+template<typename AccessImpl>
+void check_marks( Random& rng ) {
+	stt::STF<AccessImpl, stt::ArenaStorage<stt::MarkNode>> f( NUM_VERTICES );
+	NaiveForest g( NUM_VERTICES );
+	std::vector<bool> marked( NUM_VERTICES, false );
+	for( size_t step = 0; step < NUM_STEPS / 2; step++ ) {
+		const size_t v = rng() % NUM_VERTICES;
+		switch( rng() % 4 ) {
+			case 0 :
+				random_link_or_cut( g, rng, [&]( size_t a, size_t b ) { f.link( a, b ); }, [&]( size_t a, size_t b ) { f.cut( a, b ); } );
+				break;
+			case 1 :
+				marked[v] = !marked[v];
+				f.set_marked( v, marked[v] );
+				break;
+			default : {
+				size_t expected = NONE;
+				for( size_t x = 0; x < NUM_VERTICES; x++ ) {
+					const std::vector<size_t> path = g.path( v, x );
+					if( marked[x] && !path.empty() ) {
+						expected = std::min( expected, path.size() - 1 );
+					}
+				}
+				size_t distance;
+				const size_t m = f.nearest_marked( v, &distance );
+				if( expected == NONE ) {
+					expect( m == NONE, "nearest_marked() without marked vertices" );
+				}
+				else {
+					expect( m != NONE && marked[m] && g.path( v, m ).size() - 1 == expected && distance == expected, "nearest_marked()" );
+				}
+			}
+		}
+	}
+	
+	stt::RootedSTF<AccessImpl, stt::ArenaStorage<stt::MarkNode>> rf( NUM_VERTICES );
+	NaiveRootedForest rg( NUM_VERTICES );
+	std::fill( marked.begin(), marked.end(), false );
+	for( size_t step = 0; step < NUM_STEPS / 2; step++ ) {
+		const size_t v = rng() % NUM_VERTICES;
+		switch( rng() % 4 ) {
+			case 0 :
+				random_rooted_change( rg, rf, rng );
+				break;
+			case 1 :
+				marked[v] = !marked[v];
+				rf.set_marked( v, marked[v] );
+				break;
+			default : {
+				size_t expected = NONE;
+				for( size_t a : rg.ancestors( v ) ) {
+					if( marked[a] ) {
+						expected = a;
+						break;
+					}
+				}
+				expect( rf.nearest_marked_ancestor( v ) == expected, "nearest_marked_ancestor()" );
+			}
+		}
+	}
+}
+
+/* build() of random forests, followed by links, cuts and distance() queries, and the rejection
+ * of cycles, duplicate edges and non-isolated nodes. Also RootedSTF::build(). */
+template<typename AccessImpl>
+void check_build( Random& rng ) {
+	typedef stt::STF<AccessImpl, stt::ArenaStorage<stt::SizeNode>> F;
+	for( size_t round = 0; round < 50; round++ ) {
+		std::vector<Edge> edges = random_forest( NUM_VERTICES, rng );
+		if( edges.size() >= 2 ) {
+			// A cycle through the first edge and the path between the ends of the second
+			F invalid( NUM_VERTICES );
+			NaiveForest tree( NUM_VERTICES );
+			for( const Edge& e : edges ) {
+				tree.link( e.first, e.second );
+			}
+			std::vector<Edge> with_cycle = edges;
+			with_cycle.push_back( Edge( edges[1].second, edges[1].first ) );
+			expect( build_throws( invalid, with_cycle ), "build() with a duplicate edge must throw" );
+			with_cycle.back() = Edge( edges[0].first, edges[0].first );
+			expect( build_throws( invalid, with_cycle ), "build() with a loop must throw" );
+			for( size_t u = 0; u < NUM_VERTICES; u++ ) {
+				const std::vector<size_t> path = tree.path( u, edges[0].first );
+				if( path.size() >= 3 ) {
+					with_cycle.back() = Edge( u, edges[0].first );
+					expect( build_throws( invalid, with_cycle ), "build() with a cycle must throw" );
+					break;
+				}
+			}
+			invalid.link( edges[0].first, edges[0].second );
+			expect( build_throws( invalid, std::vector<Edge>( edges.begin() + 1, edges.end() ) ), "build() with a non-isolated node must throw" );
+		}
+		
+		F f( NUM_VERTICES );
+		NaiveForest g( NUM_VERTICES );
+		f.build( edges );
+		for( const Edge& e : edges ) {
+			g.link( e.first, e.second );
+		}
+		for( size_t step = 0; step < 200; step++ ) {
+			const size_t u = rng() % NUM_VERTICES;
+			const size_t v = rng() % NUM_VERTICES;
+			if( rng() % 4 == 0 ) {
+				random_link_or_cut( g, rng, [&]( size_t a, size_t b ) { f.link( a, b ); }, [&]( size_t a, size_t b ) { f.cut( a, b ); } );
+			}
+			else {
+				const std::vector<size_t> path = g.path( u, v );
+				expect( f.distance( u, v ) == ( path.empty() ? NONE : path.size() - 1 ), "distance() after build()" );
+			}
+		}
+		
+		stt::RootedSTF<AccessImpl> rf( NUM_VERTICES );
+		NaiveRootedForest rg( NUM_VERTICES );
+		if( !edges.empty() ) {
+			std::vector<Edge> two_parents = edges;
+			two_parents.push_back( Edge( edges[0].first, edges[0].first == 0 ? 1 : 0 ) );
+			expect( build_throws( rf, two_parents ), "RootedSTF::build() with two parents of a vertex must throw" );
+		}
+		rf.build( edges );
+		for( const Edge& e : edges ) {
+			rg.parent[e.first] = e.second;
+		}
+		for( size_t step = 0; step < 200; step++ ) {
+			const size_t v = rng() % NUM_VERTICES;
+			if( rng() % 4 == 0 ) {
+				random_rooted_change( rg, rf, rng );
+			}
+			else {
+				expect( rf.find_root( v ) == rg.root( v ), "find_root() after RootedSTF::build()" );
+				expect( rf.parent( v ) == rg.parent[v], "parent() after RootedSTF::build()" );
+			}
+		}
+	}
+}
+
+/* rebuild() with random access weights, between links, cuts, weight changes and path_aggregate()
+ * queries, and RootedSTF::rebuild() between rooted changes and lca() queries. */
+template<typename AccessImpl>
+void check_rebuild( Random& rng ) {
+	typedef stt::AggregateNode<stt::SumAggregate<long>> N;
+	stt::STF<AccessImpl, stt::ArenaStorage<N>, stt::MaintainedOptions> f( NUM_VERTICES );
+	NaiveForest g( NUM_VERTICES );
+	std::vector<long> weight( NUM_VERTICES, 0 );
+	for( size_t step = 0; step < NUM_STEPS / 2; step++ ) {
+		const size_t u = rng() % NUM_VERTICES;
+		const size_t v = rng() % NUM_VERTICES;
+		switch( rng() % 6 ) {
+			case 0 :
+				random_link_or_cut( g, rng, [&]( size_t a, size_t b ) { f.link( a, b ); }, [&]( size_t a, size_t b ) { f.cut( a, b ); } );
+				break;
+			case 1 :
+				weight[v] = long( rng() % 1000 ) - 500;
+				f.set_weight( v, weight[v] );
+				break;
+			case 2 :
+				f.rebuild( v, random_access_weights( NUM_VERTICES, rng ) );
+				break;
+			default : {
+				long sum = 0;
+				for( size_t x : g.path( u, v ) ) {
+					sum += weight[x];
+				}
+				expect( f.path_aggregate( u, v ) == sum, "path_aggregate() after rebuild()" );
+			}
+		}
+	}
+	
+	stt::RootedSTF<AccessImpl, stt::DefaultStorage, stt::MaintainedOptions> rf( NUM_VERTICES );
+	NaiveRootedForest rg( NUM_VERTICES );
+	for( size_t step = 0; step < NUM_STEPS / 2; step++ ) {
+		const size_t u = rng() % NUM_VERTICES;
+		const size_t v = rng() % NUM_VERTICES;
+		switch( rng() % 4 ) {
+			case 0 :
+				random_rooted_change( rg, rf, rng );
+				break;
+			case 1 :
+				rf.rebuild( v, random_access_weights( NUM_VERTICES, rng ) );
+				break;
+			default : {
+				// The lowest ancestor of u that is also an ancestor of v
+				const std::vector<size_t> a = rg.ancestors( u );
+				const std::vector<size_t> b = rg.ancestors( v );
+				size_t lca = NONE;
+				for( size_t x : a ) {
+					if( std::find( b.begin(), b.end(), x ) != b.end() ) {
+						lca = x;
+						break;
+					}
+				}
+				expect( rf.lca( u, v ) == lca, "lca() after RootedSTF::rebuild()" );
+			}
+		}
+	}
+}
+
+/* clone() and clone_component(): changes to the copy do not affect the original, and the
+ * distances in both match the naive forests. */
+template<typename AccessImpl>
+void check_clone( Random& rng ) {
+	typedef stt::STF<AccessImpl, stt::ArenaStorage<stt::SizeNode>, stt::MaintainedOptions> F;
+	auto expect_distances = [&]( F& f, const NaiveForest& g, const char* what ) {
+		for( size_t i = 0; i < 20; i++ ) {
+			const size_t u = rng() % g.size();
+			const size_t v = rng() % g.size();
+			const std::vector<size_t> path = g.path( u, v );
+			expect( f.distance( u, v ) == ( path.empty() ? NONE : path.size() - 1 ), what );
+		}
+	};
+	
+	F f( NUM_VERTICES );
+	NaiveForest g( NUM_VERTICES );
+	for( size_t round = 0; round < 100; round++ ) {
+		for( size_t step = 0; step < 20; step++ ) {
+			random_change( g, f, rng );
+		}
+		
+		std::unique_ptr<F> copy = f.clone();
+		NaiveForest copy_g = g;
+		for( size_t step = 0; step < 20; step++ ) {
+			random_change( copy_g, *copy, rng );
+		}
+		expect_distances( *copy, copy_g, "distance() in a clone()" );
+		expect_distances( f, g, "distance() in the original of a clone()" );
+		
+		// Vertex i of the component copy is vertices[i]
+		std::vector<size_t> vertices;
+		const size_t v = rng() % NUM_VERTICES;
+		std::unique_ptr<F> component = f.clone_component( v, vertices );
+		std::vector<size_t> index_of( NUM_VERTICES, NONE );
+		for( size_t i = 0; i < vertices.size(); i++ ) {
+			index_of[vertices[i]] = i;
+		}
+		NaiveForest component_g( vertices.size() );
+		for( const Edge& e : g.edges ) {
+			if( index_of[e.first] != NONE ) {
+				component_g.link( index_of[e.first], index_of[e.second] );
+			}
+		}
+		expect( vertices.size() == g.component_size( v ), "size of clone_component()" );
+		for( size_t step = 0; step < 20; step++ ) {
+			random_change( component_g, *component, rng );
+		}
+		expect_distances( *component, component_g, "distance() in a clone_component()" );
+		expect_distances( f, g, "distance() in the original of a clone_component()" );
+	}
+}
+
+struct Check {
+	const char* name;
+	void (*run)( Random& rng );
+};
+
+template<typename AccessImpl>
+std::vector<Check> checks() {
+	return {
+		{ "edge-weights", check_edge_weights<AccessImpl> },
+		{ "path-add", check_path_add<AccessImpl> },
+		{ "sizes", check_sizes<AccessImpl> },
+		{ "distance", check_distance<AccessImpl> },
+		{ "kth", check_kth<AccessImpl> },
+		{ "marks", check_marks<AccessImpl> },
+		{ "build", check_build<AccessImpl> },
+		{ "rebuild", check_rebuild<AccessImpl> },
+		{ "clone", check_clone<AccessImpl> },
+	};
+}
+
+// Runs the selected checks (all if none are selected). Returns whether all of them passed.
+template<typename AccessImpl>
+bool run_checks( const std::string& impl_name, const std::vector<std::string>& selected ) {
+	bool ok = true;
+	for( const Check& check : checks<AccessImpl>() ) {
+		if( !selected.empty() && std::find( selected.begin(), selected.end(), check.name ) == selected.end() ) {
+			continue;
+		}
+		std::cout << check.name << " (" << impl_name << "): ";
+		Random rng( 1 );
+		try {
+			check.run( rng );
+			std::cout << "OK\n";
+		}
+		catch( const std::exception& e ) {
+			std::cout << "FAILED: " << e.what() << "\n";
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+}
+
+int main( int argc, const char** argv ) {
+	const std::vector<std::string> selected( argv + 1, argv + argc );
+	bool ok = run_checks<MTRAccessImpl>( "mtr", selected );
+	ok = run_checks<GreedyAccessImpl>( "greedy", selected ) && ok;
+	ok = run_checks<LTPAccessImpl>( "ltp", selected ) && ok;
+	return ok ? 0 : 1;
+}
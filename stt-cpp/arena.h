@@ -0,0 +1,107 @@
+#ifndef STT_ARENA_H
+#define STT_ARENA_H
+
+#include <cstdint>
+#include <iostream>
+#include <new>
+#include <utility>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace stt {
+	/// Kind of pages backing an Arena
+	enum PageMode {
+		SMALL_PAGES, // Regular pages
+		TRANSPARENT_HUGE_PAGES, // Regular mapping, advised to be backed by transparent huge pages
+		HUGETLB_PAGES // Explicit huge pages (MAP_HUGETLB), falls back to TRANSPARENT_HUGE_PAGES
+	};
+	
+	/// Size of a huge page. Assumes the x86-64 default.
+	static const size_t HUGE_PAGE_SIZE = size_t( 1 ) << 21;
+	
+	/// Page mode of arenas that do not specify one.
+	inline PageMode& default_page_mode() {
+		static PageMode mode = SMALL_PAGES;
+		return mode;
+	}
+	
+	/* Anonymous memory mapping whose start address is a multiple of the given alignment, which must be
+	 * a power of two. The memory is zero-initialized; physical pages are only allocated when touched. */
+	class Arena {
+	public :
+		Arena( size_t size, size_t alignment, PageMode requested_mode = default_page_mode() ) : mode( requested_mode ) {
+			const size_t page_size = mode == SMALL_PAGES ? sysconf( _SC_PAGESIZE ) : HUGE_PAGE_SIZE;
+			len = ( size + page_size - 1 ) / page_size * page_size;
+			if( alignment < page_size ) {
+				alignment = page_size;
+			}
+			
+			// Reserve enough space to find an aligned range, then give back the rest.
+			const size_t reserved = len + alignment;
+			void* p = mmap( nullptr, reserved, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+			if( p == MAP_FAILED ) {
+				throw std::bad_alloc();
+			}
+			const uintptr_t start = reinterpret_cast<uintptr_t>( p );
+			const uintptr_t aligned = ( start + alignment - 1 ) & ~( uintptr_t( alignment ) - 1 );
+			if( aligned > start ) {
+				munmap( p, aligned - start );
+			}
+			if( start + reserved > aligned + len ) {
+				munmap( reinterpret_cast<void*>( aligned + len ), start + reserved - aligned - len );
+			}
+			mem = reinterpret_cast<char*>( aligned );
+			
+			if( mode == HUGETLB_PAGES ) {
+				// Replace the reserved range. Fails if not enough huge pages are configured.
+				if( mmap( mem, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_HUGETLB, -1, 0 ) == MAP_FAILED ) {
+					if( mmap( mem, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE, -1, 0 ) == MAP_FAILED ) {
+						throw std::bad_alloc();
+					}
+					warn_once( "MAP_HUGETLB failed, using transparent huge pages instead" );
+					mode = TRANSPARENT_HUGE_PAGES;
+				}
+			}
+			if( mode == TRANSPARENT_HUGE_PAGES && madvise( mem, len, MADV_HUGEPAGE ) != 0 ) {
+				warn_once( "Transparent huge pages are not available" );
+				mode = SMALL_PAGES;
+			}
+		}
+		
+		~Arena() {
+			munmap( mem, len );
+		}
+		
+		Arena( const Arena& ) = delete;
+		Arena& operator=( const Arena& ) = delete;
+		
+		[[nodiscard]] inline char* data() const { return mem; }
+		
+		[[nodiscard]] inline size_t size() const { return len; }
+		
+		/// The page mode actually used, which may differ from the requested one.
+		[[nodiscard]] inline PageMode page_mode() const { return mode; }
+		
+		void swap( Arena& other ) {
+			std::swap( mem, other.mem );
+			std::swap( len, other.len );
+			std::swap( mode, other.mode );
+		}
+	
+	private :
+		static void warn_once( const char* msg ) {
+			static bool warned = false;
+			if( !warned ) {
+				std::cerr << "Warning: " << msg << "\n";
+				warned = true;
+			}
+		}
+		
+		char* mem;
+		size_t len;
+		PageMode mode;
+	};
+}
+
+#endif
@@ -0,0 +1,14 @@
+#!/bin/bash
+
+# Compares the rotation kernels with and without branches (see rotation_bench.cpp) on the largest data files.
+
+REPEAT=5
+INPUTS=../data/con_100000_*.txt
+
+make --silent bin/rotation_bench || echo "Error in build"
+
+for f in $INPUTS; do
+  echo "### Input file: $f ###"
+  ./bin/rotation_bench $REPEAT $f || echo "Error in execution"
+  echo
+done
@@ -0,0 +1,26 @@
+#!/bin/bash
+
+# Compares the node layouts (default array of structs, compact, structure of arrays, chunked, with or
+# without stored separator types) on all data files.
+# Arguments are passed to the benchmark executables (e.g., --json).
+
+REPEAT=5
+INPUTS=../data/con_*.txt
+LAYOUTS=( "" _compact _soa _chunked _tagged _compact_tagged )
+
+for impl in mtr_stt greedy_stt ltp_stt; do
+  for layout in "${LAYOUTS[@]}"; do
+    make --silent bin/$impl$layout || echo "Error in build"
+  done
+done
+
+for f in $INPUTS; do
+  echo "### Input file: $f ###"
+  for impl in mtr_stt greedy_stt ltp_stt; do
+    for layout in "${LAYOUTS[@]}"; do
+      echo "++ $impl$layout ++"
+      ./bin/$impl$layout bench "$@" $REPEAT $f || echo "Error in execution"
+      echo
+    done
+  done
+done
@@ -0,0 +1,23 @@
+#!/bin/bash
+
+# Compares the page modes of the node storage (see --pages) on all data files.
+# Arguments are passed to the benchmark executables (e.g., --json).
+
+REPEAT=5
+INPUTS=../data/con_*.txt
+PAGES=( small thp hugetlb )
+
+for impl in mtr_stt greedy_stt ltp_stt; do
+  make --silent bin/$impl || echo "Error in build"
+done
+
+for f in $INPUTS; do
+  echo "### Input file: $f ###"
+  for impl in mtr_stt greedy_stt ltp_stt; do
+    for pages in "${PAGES[@]}"; do
+      echo "++ $impl --pages=$pages ++"
+      ./bin/$impl --pages=$pages bench "$@" $REPEAT $f || echo "Error in execution"
+      echo
+    done
+  done
+done
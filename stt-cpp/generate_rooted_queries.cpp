@@ -0,0 +1,88 @@
+#include "parse_input.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+
+// Root of the tree containing v, given the parent of each vertex (-1 for roots)
+static long find_root( const std::vector<long>& parent, long v ) {
+	while( parent[v] >= 0 ) {
+		v = parent[v];
+	}
+	return v;
+}
+
+// Query types of the connected pairs of each mix, chosen uniformly
+static const QueryType LCA_MIX[] = { CUT_FROM_PARENT, EVERT, FIND_ROOT, PATH, LCA, LCA, LCA, LCA };
+static const QueryType EVERT_MIX[] = { CUT_FROM_PARENT, EVERT, EVERT, EVERT, FIND_ROOT, FIND_ROOT, FIND_ROOT, LCA };
+
+/* Writes random queries on rooted trees to stdout, in the format of read_query_file(). Each query
+ * picks two random vertices u and v. If they are not connected, the root of u becomes a child of v.
+ * Otherwise, it is a cut of u from its parent, an evert of u, a find-root query of u, a path query
+ * or an LCA query of u and v. With the mix "lca" (the default), half of these are LCA queries, and
+ * with "evert", most are everts and find-root queries. */
+int main( int argc, const char** argv ) {
+	const std::string mix = argc == 5 ? argv[4] : "lca";
+	if( ( argc != 4 && argc != 5 ) || ( mix != "lca" && mix != "evert" ) ) {
+		std::cout << "usage: " << argv[0] << " <num-vertices> <num-queries> <seed> [lca|evert]\n";
+		return 1;
+	}
+	const QueryType* types = mix == "lca" ? LCA_MIX : EVERT_MIX;
+	const long n = std::atol( argv[1] );
+	const long q = std::atol( argv[2] );
+	if( n < 2 || q < 0 ) {
+		std::cerr << "Need at least 2 vertices and a non-negative number of queries\n";
+		return 1;
+	}
+	std::mt19937_64 rng( std::strtoull( argv[3], nullptr, 10 ) );
+	
+	std::vector<long> parent( n, -1 );
+	std::vector<Query> queries;
+	queries.reserve( q );
+	while( long( queries.size() ) < q ) {
+		const long u = rng() % n;
+		const long v = rng() % n;
+		if( u == v ) {
+			continue;
+		}
+		const long r = find_root( parent, u );
+		if( r != find_root( parent, v ) ) {
+			parent[r] = v;
+			queries.push_back( Query( LINK, r, v ) );
+			continue;
+		}
+		QueryType type = types[rng() % 8];
+		if( type == CUT_FROM_PARENT && parent[u] < 0 ) {
+			type = EVERT; // Of a root, i.e., a no-op
+		}
+		switch( type ) {
+			case CUT_FROM_PARENT :
+				parent[u] = -1;
+				queries.push_back( Query( CUT_FROM_PARENT, u ) );
+				break;
+			case EVERT : {
+				// Reverse the path to the root
+				long prev = -1;
+				for( long x = u; x >= 0; ) {
+					const long next = parent[x];
+					parent[x] = prev;
+					prev = x;
+					x = next;
+				}
+				queries.push_back( Query( EVERT, u ) );
+				break;
+			}
+			case FIND_ROOT :
+				queries.push_back( Query( FIND_ROOT, u ) );
+				break;
+			case PATH :
+				queries.push_back( Query( PATH, u, v ) );
+				break;
+			default :
+				queries.push_back( Query( LCA, u, v ) );
+		}
+	}
+	write_query_file( std::cout, n, queries );
+	return 0;
+}
@@ -0,0 +1,230 @@
+#ifndef GREEDY_STT_H
+#define GREEDY_STT_H
+
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "parse_input.h"
+#include "stt.h"
+#include "stt_impl.h"
+
+/** Variants
+ * 0: Naive greedy from paper
+ * 1: Semi-naive greedy from rust impl
+ * 2: Slightly improved 11
+ * 3: Improved 12 with NST
+ * 4: Variant of 3 that prefetches the great-grandparent
+ * 5: Variant of 3 with branch-free rotation kernels
+ * 6: Variant of 3 with splay steps as two rotations instead of the fused kernel
+ */
+
+namespace greedy_stt {
+	using namespace stt;
+
+/// Access implementation for each variant
+	
+	template<int Variant>
+	struct Access;
+	
+	// Very naive Greedy impl from paper
+	template<>
+	struct Access<0> {
+		typedef ImprovedRotation Rotation;
+		
+		template<typename R = Rotation, typename NodeRef>
+		static inline void access( NodeRef v ) {
+			while( v->parent ) {
+				if( can_splay_step( v ) ) {
+					splay_step<R>( v );
+				}
+				else if( can_splay_step<NodeRef>( v->parent ) ) {
+					splay_step<R, NodeRef>( v->parent );
+				}
+				else {
+					assert( can_splay_step<NodeRef>( v->parent->parent ) );
+					splay_step<R, NodeRef>( v->parent->parent );
+				}
+			}
+		}
+	};
+	
+	// Naive Greedy impl from Rust lib
+	template<>
+	struct Access<1> {
+		typedef ImprovedRotation Rotation;
+		
+		template<typename R = Rotation, typename NodeRef>
+		static inline void access( NodeRef v ) {
+			while( NodeRef p = v->parent ) {
+				if( NodeRef g = p->parent ) {
+					if( NodeRef gg = g->parent ) {
+						bool v_sep = v->is_separator_hint( p );
+						bool p_sep = p->is_separator_hint( g );
+						bool g_sep = g->is_separator_hint( gg );
+						if( ( v_sep && p_sep ) || !g_sep ) { // Can splay at v
+							splay_step_full<R>( v, p );
+						}
+						else { // Cannot splay at v
+							if( NodeRef ggg = gg->parent ) {
+								bool gg_sep = gg->is_separator_hint( ggg );
+								if( ( p_sep && g_sep ) || !gg_sep ) { // Can splay at p
+									splay_step_full<R>( p, g );
+								}
+								else { // Cannot splay at p, so splaying at g must be allowed
+									splay_step_full<R>( g, gg );
+								}
+							}
+							else { // ggg is root, splaying at p must be allowed
+								splay_step_full<R>( p, g );
+							}
+						}
+					}
+					else { // g is root, splaying at v must be allowed
+						splay_step_full<R>( v, p );
+					}
+				}
+				else { // p is root
+					R::rotate( v );
+				}
+			}
+		}
+	};
+	
+	// Improved Greedy impl from Rust lib
+	template<>
+	struct Access<2> {
+		typedef ImprovedRotation Rotation;
+		
+		template<typename R = Rotation, typename NodeRef>
+		static inline void access( NodeRef v ) {
+			while( NodeRef p = v->parent ) {
+				if( NodeRef g = p->parent ) {
+					bool v_sep = v->is_separator_hint( p );
+					bool p_sep = p->is_separator_hint( g );
+					if( v_sep && p_sep ) { // Can splay at v
+						splay_step_full<R>( v, p );
+					}
+					else if( NodeRef gg = g->parent ) { // !v_sep or !p_sep
+						bool g_sep = g->is_separator_hint( gg );
+						if( !g_sep ) { // Can splay at v
+							splay_step_full<R>( v, p );
+						}
+						else if( p_sep ) { // g_sep and p_sep => can splay at p
+							splay_step_full<R>( p, g );
+						}
+						else { // Cannot splay at v and g_sep and !p_sep
+							if( NodeRef ggg = gg->parent ) {
+								bool gg_sep = gg->is_separator_hint( ggg );
+								if( !gg_sep ) { // Can splay at p
+									splay_step_full<R>( p, g );
+								}
+								else { // Cannot splay at p, so splaying at g must be allowed
+									splay_step_full<R>( g, gg );
+								}
+							}
+							else { // ggg is root, splaying at p must be allowed
+								splay_step_full<R>( p, g );
+							}
+						}
+					}
+					else { // g is root, splaying at v must be allowed
+						splay_step_full<R>( v, p );
+					}
+				}
+				else { // p is root
+					R::rotate( v );
+				}
+			}
+		}
+	};
+	
+	// Improved Greedy impl from Rust lib, using NodeSepType (variants 3 and 4)
+	template<bool Prefetch>
+	struct NSTAccess {
+		typedef NSTRotation Rotation;
+		
+		template<typename R = Rotation, typename NodeRef>
+		static inline void access( NodeRef v ) {
+			while( NodeRef p = v->parent ) {
+				if( NodeRef g = p->parent ) {
+					if( Prefetch ) {
+						// After the splay step, the next iteration starts at gg or below, so fetch gg. Its
+						// parent is not fetched, since reading it would wait for gg.
+						prefetch_node<NodeRef>( NodeRef( g->parent ) );
+					}
+					NodeSepType v_sep = v->get_sep_type_hint( p );
+					NodeSepType p_sep = p->get_sep_type_hint( g );
+					
+					// Try splaying at v without information about g's NodeSepType.
+					if( v_sep != NOSEP && p_sep != NOSEP ) {
+						splay_step_type_hint<R>( v, v_sep, p, p_sep );
+					}
+					// Either v or p is not a separator
+					else if( NodeRef gg = g->parent ) {
+						NodeSepType g_sep = g->get_sep_type_hint( gg );
+						if( g_sep == NOSEP ) { // Can splay at v
+							splay_step_type_hint<R>( v, v_sep, p, p_sep );
+						}
+						else if( p_sep != NOSEP ) { // g_sep and p_sep => can splay at p
+							splay_step_type_hint<R>( p, p_sep, g, g_sep );
+						}
+						else { // Cannot splay at v and g_sep and !p_sep
+							NodeRef ggg = gg->parent; // Must exist, since g_sep
+							assert( gg->parent );
+							NodeSepType gg_sep = gg->get_sep_type_hint( ggg );
+							if( gg_sep == NOSEP ) { // Can splay at p
+								splay_step_type_hint<R>( p, p_sep, g, g_sep );
+							}
+							else { // Cannot splay at p, so splaying at g must be allowed
+								splay_step_type_hint<R>( g, g_sep, gg, gg_sep );
+							}
+						}
+					}
+					else { // g is root, splaying at v must be allowed
+						splay_step_type_hint<R>( v, v_sep, p, p_sep );
+					}
+				}
+				else { // p is root
+					R::rotate( v );
+				}
+			}
+		}
+	};
+	
+	template<>
+	struct Access<3> : NSTAccess<false> {};
+	
+	template<>
+	struct Access<4> : NSTAccess<true> {};
+	
+	template<>
+	struct Access<5> : WithRotation<Access<3>, BranchlessRotation> {};
+	
+	template<>
+	struct Access<6> : WithRotation<Access<3>, UnfusedRotation> {};
+	
+	static const int DEFAULT_VARIANT = 3;
+	
+	template<int Variant>
+	static inline void add_variant( std::vector<NamedImpl>& impls ) {
+		impls.push_back( named_stt_impl<Access<Variant>>( "greedy" + std::to_string( Variant ) ) );
+	}
+	
+	/// Adds all variants as "greedy0" to "greedy6", starting with the default.
+	static inline void add_variants( std::vector<NamedImpl>& impls ) {
+		add_variant<DEFAULT_VARIANT>( impls );
+		add_variant<0>( impls );
+		add_variant<1>( impls );
+		add_variant<2>( impls );
+		add_variant<4>( impls );
+		add_variant<5>( impls );
+		add_variant<6>( impls );
+	}
+}
+
+using GreedyAccessImpl = greedy_stt::Access<greedy_stt::DEFAULT_VARIANT>;
+
+using GreedySTF = stt::STF<GreedyAccessImpl>;
+
+#endif
@@ -0,0 +1,432 @@
+#ifndef LTP_STT_H
+#define LTP_STT_H
+
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "parse_input.h"
+#include "stt.h"
+#include "stt_impl.h"
+
+/**
+ * Local Two-Pass SplayTT
+ * Two basic variants:
+ * LTP-A: As in original rust implementation/ALENEX paper; almost the same as Two-Pass SplayTT
+ * LTP-B: Variant with less lookahead, as in thesis (replace splay_step at grandparent with single rotation when possible)
+ *
+ * Variants:
+ * 0: Shortest possible LTB-A implementation
+ * 1/2: Improved LTB-A/B impl from rust lib
+ * 3/4: LTB-A/B impl using functions with NodeSepType
+ * 5/6: Variant of 3/4 that reuses computed NodeSepType between loop runs, if possible
+ * 7/8: Variant of 3/4 that tries to reduce re-checking of separator types with a helper loop
+ * 9: Variant of 8 that reuses computed NodeSepType in the helper loop
+ * 10: Variant of 8 that prefetches the great-grandparent
+ * 11: Variant of 8 with branch-free rotation kernels
+ * 12: Variant of 8 with splay steps as two rotations instead of the fused kernel
+ */
+
+namespace ltp_stt {
+	using namespace stt;
+
+/// Access implementation for each variant
+	
+	template<int Variant>
+	struct Access;
+	
+	// Very naive LTP impl
+	template<>
+	struct Access<0> {
+		typedef ImprovedRotation Rotation;
+		
+		template<typename R = Rotation, typename NodeRef>
+		static inline void access( NodeRef v ) {
+			while( v->parent ) {
+				if( can_splay_step( v ) ) {
+					splay_step<R>( v );
+				}
+				else if( v->parent->is_separator() ) {
+					splay_step<R, NodeRef>( v->parent );
+				}
+				else {
+					NodeRef g = v->parent->parent;
+					if( can_splay_step( g ) ) {
+						splay_step<R>( g );
+					}
+					else {
+						R::rotate( g );
+					}
+				}
+			}
+		}
+	};
+	
+	// Naive impl from old Rust lib (variants 1 and 2)
+	template<bool LTPA>
+	struct RustAccess {
+		typedef ImprovedRotation Rotation;
+		
+		template<typename R = Rotation, typename NodeRef>
+		static inline void access( NodeRef v ) {
+			while( NodeRef p = v->parent ) {
+				if( NodeRef g = p->parent ) {
+					if( NodeRef gg = g->parent ) {
+						bool v_sep = v->is_separator_hint( p );
+						bool p_sep = p->is_separator_hint( g );
+						bool g_sep = g->is_separator_hint( gg );
+						if( ( v_sep && p_sep ) || !g_sep ) { // Can splay at v
+							splay_step_full<R>( v, p );
+						}
+						else if( p_sep ) {
+							splay_step_full<R>( p, g );
+						}
+						else {
+							NodeRef ggg = gg->parent; // Must exist, since g_sep
+							assert( ggg );
+							if( gg->is_separator_hint( ggg ) || ( LTPA && ! ggg->is_separator() ) ) {
+								splay_step_full<R>( g, gg );
+							}
+							else { // ggg is root, splaying at p must be allowed
+								splay_step_full<R>( p, g );
+							}
+						}
+					}
+					else { // g is root, splaying at v must be allowed
+						splay_step_full<R>( v, p );
+					}
+				}
+				else { // p is root
+					R::rotate( v );
+				}
+			}
+		}
+	};
+	
+	template<>
+	struct Access<1> : RustAccess<true> {};
+	
+	template<>
+	struct Access<2> : RustAccess<false> {};
+	
+	// Improved impl with NodeSepType (variants 3 and 4)
+	template<bool LTPA>
+	struct NSTAccess {
+		typedef NSTRotation Rotation;
+		
+		template<typename R = Rotation, typename NodeRef>
+		static inline void access( NodeRef v ) {
+			while( NodeRef p = v->parent ) {
+				if( NodeRef g = p->parent ) {
+					NodeSepType v_sep = v->get_sep_type_hint( p );
+					NodeSepType p_sep = p->get_sep_type_hint( g );
+					
+					// Try splaying at v without information about g's NodeSepType.
+					if( v_sep != NOSEP && p_sep != NOSEP ) {
+						splay_step_type_hint<R>( v, v_sep, p, p_sep );
+					}
+					// Either v or p is not a separator
+					else if( NodeRef gg = g->parent ) {
+						NodeSepType g_sep = g->get_sep_type_hint( gg );
+						if( g_sep == NOSEP ) { // Can splay at v
+							splay_step_type_hint<R>( v, v_sep, p, p_sep );
+						}
+						else if( p_sep != NOSEP ) { // g_sep and p_sep => can splay at p
+							splay_step_type_hint<R>( p, p_sep, g, g_sep );
+						}
+						else { // !p_sep and g_sep
+							NodeRef ggg = gg->parent; // Must exist, since g_sep
+							assert( ggg );
+							NodeSepType gg_sep = gg->get_sep_type_hint( ggg );
+							if( gg_sep != NOSEP || ( LTPA && ggg->get_sep_type() == NOSEP ) ) { // Can splay at g
+								splay_step_type_hint<R>( g, g_sep, gg, gg_sep );
+							}
+							else {
+								R::rotate_type_hint( g, g_sep );
+							}
+						}
+					}
+					else { // g is root, splaying at v must be allowed
+						splay_step_type_hint<R>( v, v_sep, p, p_sep );
+					}
+				}
+				else { // p is root
+					R::rotate( v );
+				}
+			}
+		}
+	};
+	
+	template<>
+	struct Access<3> : NSTAccess<true> {};
+	
+	template<>
+	struct Access<4> : NSTAccess<false> {};
+	
+	// Improved impl with remembered NodeSepType (variants 5 and 6)
+	template<bool LTPA>
+	struct RememberingAccess {
+		typedef NSTRotation Rotation;
+		
+		template<typename R = Rotation, typename NodeRef>
+		static inline void access( NodeRef v ) {
+			if( NodeRef p = v->parent ) {
+				if( NodeRef g = p->parent ) {
+					NodeSepType v_sep = v->get_sep_type_hint( p );
+					NodeSepType p_sep = p->get_sep_type_hint( g );
+					
+					while( true ) {
+						// Try splaying at v without information about g's NodeSepType.
+						if( v_sep != NOSEP && p_sep != NOSEP ) {
+							splay_step_type_hint<R>( v, v_sep, p, p_sep );
+							// Recompute NSTs or finish
+							if( (p = v->parent) ) {
+								if( (g = p->parent) ) {
+									v_sep = v->get_sep_type_hint( p );
+									p_sep = p->get_sep_type_hint( g );
+								}
+								else {
+									R::rotate( v );
+									return;
+								}
+							}
+							else { return; }
+						}
+						// Either v or p is not a separator
+						else if( NodeRef gg = g->parent ) {
+							NodeSepType g_sep = g->get_sep_type_hint( gg );
+							if( g_sep == NOSEP ) { // Can splay at v
+								splay_step_type_hint<R>( v, v_sep, p, p_sep );
+								// Recompute NSTs or finish
+								if( (p = v->parent) ) {
+									if( (g = p->parent) ) {
+										v_sep = g_sep;
+										p_sep = p->get_sep_type_hint( g );
+									}
+									else {
+										R::rotate( v );
+										return;
+									}
+								}
+								else { return; }
+							}
+							else if( p_sep != NOSEP ) { // g_sep and p_sep => can splay at p
+								splay_step_type_hint<R>( p, p_sep, g, g_sep );
+								// Recompute NSTs or finish
+								if( (g = p->parent) ) {
+									p_sep = p->get_sep_type_hint( g );
+								}
+								else {
+									R::rotate( v );
+									return;
+								}
+							}
+							else { // !p_sep and g_sep
+								NodeRef ggg = gg->parent; // Must exist, since g_sep
+								assert( ggg );
+								NodeSepType gg_sep = gg->get_sep_type_hint( ggg );
+								if( gg_sep != NOSEP || ( LTPA && ggg->get_sep_type() == NOSEP ) ) { // Can splay at g
+									splay_step_type_hint<R>( g, g_sep, gg, gg_sep );
+									// v and p stay the same, since !p_sep
+								}
+								else {
+									R::rotate_type_hint( g, g_sep );
+									// v and p stay the same, since !p_sep
+								}
+							}
+						}
+						else { // g is root, splaying at v must be allowed
+							splay_step_type_hint<R>( v, v_sep, p, p_sep );
+							return;
+						}
+					}
+				}
+				else { // p is root
+					R::rotate( v );
+				}
+			}
+		}
+	};
+	
+	template<>
+	struct Access<5> : RememberingAccess<true> {};
+	
+	template<>
+	struct Access<6> : RememberingAccess<false> {};
+	
+	// Improved impl with NodeSepType and less re-trying (variants 7, 8 and 10)
+	template<bool LTPA, bool Prefetch>
+	struct BranchingAccess {
+		typedef NSTRotation Rotation;
+		
+		template<typename R, typename NodeRef>
+		static inline void move_branching_node( NodeRef v ) {
+			// Rotate branching node up until it's not a branching node anymore
+			while( NodeRef p = v->parent ) {
+				auto v_sep = v->get_sep_type_hint( p );
+				if( v_sep == NOSEP ) {
+					return;
+				}
+				NodeRef g = p->parent; // Must exist, since v is separator
+				auto p_sep = p->get_sep_type_hint( g );
+				if( p_sep != NOSEP ) { // p is separator, can splay
+					splay_step_type_hint<R>( v, v_sep, p, p_sep );
+				}
+				else if( LTPA && g->get_sep_type() == NOSEP ) { // g is no separator, can splay and stop afterwards
+					splay_step_type_hint<R>( v, v_sep, p, p_sep );
+					return; // v is no separator anymore
+				}
+				else {
+					R::rotate_type_hint( v, v_sep );
+					return; // v is no separator anymore
+				}
+			}
+		}
+		
+		template<typename R = Rotation, typename NodeRef>
+		static inline void access( NodeRef v ) {
+			while( NodeRef p = v->parent ) {
+				if( NodeRef g = p->parent ) {
+					if( Prefetch ) {
+						// After the splay step, the next iteration starts at gg or below, so fetch gg. Its
+						// parent is not fetched, since reading it would wait for gg.
+						prefetch_node<NodeRef>( NodeRef( g->parent ) );
+					}
+					NodeSepType v_sep = v->get_sep_type_hint( p );
+					NodeSepType p_sep = p->get_sep_type_hint( g );
+					
+					// Try splaying at v without information about g's NodeSepType.
+					if( v_sep != NOSEP && p_sep != NOSEP ) {
+						splay_step_type_hint<R>( v, v_sep, p, p_sep );
+					}
+					// Either v or p is not a separator
+					else if( NodeRef gg = g->parent ) {
+						NodeSepType g_sep = g->get_sep_type_hint( gg );
+						if( g_sep == NOSEP ) { // Can splay at v
+							splay_step_type_hint<R>( v, v_sep, p, p_sep );
+						}
+						else if( p_sep != NOSEP ) { // g_sep and p_sep => can splay at p
+							splay_step_type_hint<R>( p, p_sep, g, g_sep );
+						}
+						else { // !p_sep and g_sep
+							move_branching_node<R>( g );
+						}
+					}
+					else { // g is root, splaying at v must be allowed
+						splay_step_type_hint<R>( v, v_sep, p, p_sep );
+					}
+				}
+				else { // p is root
+					R::rotate( v );
+				}
+			}
+		}
+	};
+	
+	template<>
+	struct Access<7> : BranchingAccess<true, false> {};
+	
+	template<>
+	struct Access<8> : BranchingAccess<false, false> {};
+	
+	template<>
+	struct Access<10> : BranchingAccess<false, true> {};
+	
+	// Variant of LTB-B that remembers NodeSepType in move_branching_node
+	template<>
+	struct Access<9> {
+		typedef NSTRotation Rotation;
+		
+		template<typename R, typename NodeRef>
+		static inline void move_branching_node( NodeRef v, NodeSepType v_sep ) {
+			// Rotate branching node up until it's not a branching node anymore
+			NodeRef p = v->parent;
+			while( v_sep != NOSEP ) {
+				NodeRef g = p->parent; // Must exist, since v is separator
+				auto p_sep = p->get_sep_type_hint( g );
+				if( p_sep != NOSEP ) { // p is separator, can splay
+					splay_step_type_hint<R>( v, v_sep, p, p_sep );
+					p = v->parent;
+					if( p ) {
+						v_sep = v->get_sep_type_hint( p );
+					}
+					else { return; }
+				}
+				else {
+					R::rotate_type_hint( v, v_sep );
+					return; // v is no separator anymore
+				}
+			}
+		}
+		
+		template<typename R = Rotation, typename NodeRef>
+		static inline void access( NodeRef v ) {
+			while( NodeRef p = v->parent ) {
+				if( NodeRef g = p->parent ) {
+					NodeSepType v_sep = v->get_sep_type_hint( p );
+					NodeSepType p_sep = p->get_sep_type_hint( g );
+					
+					// Try splaying at v without information about g's NodeSepType.
+					if( v_sep != NOSEP && p_sep != NOSEP ) {
+						splay_step_type_hint<R>( v, v_sep, p, p_sep );
+					}
+					// Either v or p is not a separator
+					else if( NodeRef gg = g->parent ) {
+						NodeSepType g_sep = g->get_sep_type_hint( gg );
+						if( g_sep == NOSEP ) { // Can splay at v
+							splay_step_type_hint<R>( v, v_sep, p, p_sep );
+						}
+						else if( p_sep != NOSEP ) { // g_sep and p_sep => can splay at p
+							splay_step_type_hint<R>( p, p_sep, g, g_sep );
+						}
+						else { // !p_sep and g_sep
+							move_branching_node<R>( g, g_sep );
+						}
+					}
+					else { // g is root, splaying at v must be allowed
+						splay_step_type_hint<R>( v, v_sep, p, p_sep );
+					}
+				}
+				else { // p is root
+					R::rotate( v );
+				}
+			}
+		}
+	};
+	
+	template<>
+	struct Access<11> : WithRotation<Access<8>, BranchlessRotation> {};
+	
+	template<>
+	struct Access<12> : WithRotation<Access<8>, UnfusedRotation> {};
+	
+	static const int DEFAULT_VARIANT = 8;
+	
+	template<int Variant>
+	static inline void add_variant( std::vector<NamedImpl>& impls ) {
+		impls.push_back( named_stt_impl<Access<Variant>>( "ltp" + std::to_string( Variant ) ) );
+	}
+	
+	/// Adds all variants as "ltp0" to "ltp12", starting with the default.
+	static inline void add_variants( std::vector<NamedImpl>& impls ) {
+		add_variant<DEFAULT_VARIANT>( impls );
+		add_variant<0>( impls );
+		add_variant<1>( impls );
+		add_variant<2>( impls );
+		add_variant<3>( impls );
+		add_variant<4>( impls );
+		add_variant<5>( impls );
+		add_variant<6>( impls );
+		add_variant<7>( impls );
+		add_variant<9>( impls );
+		add_variant<10>( impls );
+		add_variant<11>( impls );
+		add_variant<12>( impls );
+	}
+}
+
+using LTPAccessImpl = ltp_stt::Access<ltp_stt::DEFAULT_VARIANT>;
+
+using LTPSTF = stt::STF<LTPAccessImpl>;
+
+#endif
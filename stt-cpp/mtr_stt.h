@@ -0,0 +1,285 @@
+#ifndef MTR_STT_H
+#define MTR_STT_H
+
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "parse_input.h"
+#include "stt.h"
+#include "stt_impl.h"
+
+/** Variants
+ * 0: Naive MTR
+ * 1-6: MTR
+ * 7: Variant of 6 that prefetches the grandparent
+ * 8: Variant of 6 with branch-free rotation kernels
+ */
+
+namespace mtr_stt {
+	using namespace stt;
+	
+	/// Access implementation for each variant
+	template<int Variant>
+	struct Access;
+	
+	// Naive MTR impl
+	template<>
+	struct Access<0> {
+		typedef BasicRotation Rotation;
+		
+		template<typename R = Rotation, typename NodeRef>
+		static inline void access( NodeRef v ) {
+			while( NodeRef p = v->parent ) {
+				if( !v->is_separator_hint( p ) ) {
+					while( NodeRef g = p->parent ) {
+						if( p->is_separator_hint( g ) ) {
+							R::rotate( p );
+//								std::cout << *this << "\n";
+							continue;
+						}
+						break;
+					}
+				}
+				// Now either v is a separator, or p is not, meaning we are allowed to rotate at v.
+				R::rotate( v );
+			}
+		}
+	};
+	
+	template<>
+	struct Access<1> {
+		typedef ImprovedRotation Rotation;
+		
+		template<typename R = Rotation, typename NodeRef>
+		static inline void access( NodeRef v ) {
+			while( NodeRef p = v->parent ) {
+				if( !v->is_separator_hint( p ) ) {
+					// Rotate at p as long as p is a separator
+					if( NodeRef g = p->parent ) {
+						bool is_p_sep = p->is_separator_hint( g );
+						while( is_p_sep ) {
+							is_p_sep = R::rotate( p );
+						}
+					}
+				}
+				// Now either v is a separator, or p is not, meaning we are allowed to rotate at v.
+				R::rotate( v );
+			}
+		}
+	};
+	
+	template<>
+	struct Access<2> {
+		typedef ImprovedRotation Rotation;
+		
+		template<typename R = Rotation, typename NodeRef>
+		static inline void access( NodeRef v ) {
+			NodeRef p = v->parent;
+			
+			if( p == nullptr ) {
+				return;
+			}
+			
+			bool is_v_sep = v->is_separator_hint( p );
+			while( true ) {
+				if( !is_v_sep ) {
+					// Rotate at p as long as p is a separator
+					if( NodeRef g = p->parent ) {
+						bool is_p_sep = p->is_separator_hint( g );
+						while( is_p_sep ) {
+							is_p_sep = R::rotate( p );
+						}
+					}
+				}
+				// Now either v is a separator, or p is not, meaning we are allowed to rotate at v.
+				is_v_sep = R::rotate( v );
+				// Now v may not be a separator anymore
+				p = v->parent;
+				if( p == nullptr ) {
+					return;
+				}
+			}
+		}
+	};
+	
+	template<>
+	struct Access<3> {
+		typedef ImprovedRotation Rotation;
+		
+		template<typename R = Rotation, typename NodeRef>
+		static inline void access( NodeRef v ) {
+			bool is_v_sep = v->is_separator();
+			while( NodeRef p = v->parent ) {
+				if( !is_v_sep ) {
+					// Rotate at p as long as p is a separator
+					if( NodeRef g = p->parent ) {
+						bool is_p_sep = p->is_separator_hint( g );
+						while( is_p_sep ) {
+							is_p_sep = R::rotate( p );
+						}
+					}
+				}
+				// Now either v is a separator, or p is not, meaning we are allowed to rotate at v.
+				is_v_sep = R::rotate( v );
+			}
+		}
+	};
+	
+	template<>
+	struct Access<4> {
+		typedef NSTRotation Rotation;
+		
+		template<typename R = Rotation, typename NodeRef>
+		static inline void access( NodeRef v ) {
+			NodeSepType v_sep_type = v->get_sep_type();
+			while( NodeRef p = v->parent ) {
+				if( v_sep_type == NOSEP ) {
+					// Rotate at p as long as p is a separator
+					auto p_sep_type = p->get_sep_type();
+					while( p_sep_type != NOSEP ) {
+						if( p_sep_type == DSEP ) {
+							p_sep_type = R::rotate( p );
+						}
+						else { // p_sep_type == ISEP
+							assert( p_sep_type == ISEP );
+							p_sep_type = R::rotate( p );
+						}
+						assert( p_sep_type == p->get_sep_type() );
+					}
+					assert( !p->is_separator() );
+					
+					// Now both v and p are NOSEP
+					v_sep_type = R::rotate( v );
+				}
+				else if( v_sep_type == DSEP ) {
+					v_sep_type = R::rotate( v );
+				}
+				else {
+					assert( v_sep_type == ISEP );
+					v_sep_type = R::rotate( v );
+				}
+			}
+		}
+	};
+	
+	template<>
+	struct Access<5> {
+		typedef NSTRotation Rotation;
+		
+		template<typename R = Rotation, typename NodeRef>
+		static inline void access( NodeRef v ) {
+			NodeSepType v_sep_type = v->get_sep_type();
+			while( NodeRef p = v->parent ) {
+				if( v_sep_type == NOSEP ) {
+					// Rotate at p as long as p is a separator
+					auto p_sep_type = p->get_sep_type();
+					while( p_sep_type != NOSEP ) {
+						if( p_sep_type == DSEP ) {
+							p_sep_type = R::rotate_dsep( p );
+						}
+						else { // p_sep_type == ISEP
+							assert( p_sep_type == ISEP );
+							p_sep_type = R::rotate_isep( p );
+						}
+						assert( p_sep_type == p->get_sep_type() );
+					}
+					assert( !p->is_separator() );
+					
+					// Now both v and p are NOSEP
+					v_sep_type = R::rotate_nosep( v );
+					// Note: from here on, v_sep_type can never become anything else than nosep
+				}
+				else if( v_sep_type == DSEP ) {
+					v_sep_type = R::rotate_dsep( v );
+				}
+				else {
+					assert( v_sep_type == ISEP );
+					v_sep_type = R::rotate_isep( v );
+				}
+			}
+		}
+	};
+	
+	// Variants 6 and 7
+	template<bool Prefetch>
+	struct SplitAccess {
+		typedef NSTRotation Rotation;
+		
+		template<typename R = Rotation, typename NodeRef>
+		static inline void access( NodeRef v ) {
+			NodeSepType v_sep_type = v->get_sep_type();
+			while( v_sep_type != NOSEP ) {
+				if( v_sep_type == DSEP ) {
+					v_sep_type = R::rotate_dsep( v );
+				}
+				else {
+					assert( v_sep_type == ISEP );
+					v_sep_type = R::rotate_isep( v );
+				}
+			}
+			
+			while( NodeRef p = v->parent) {
+				assert( !v->is_separator() );
+				
+				if( Prefetch ) {
+					// The next iteration continues at the grandparent, so fetch it while rotating. Its
+					// parent is not known without waiting for it, so it is not fetched.
+					prefetch_node<NodeRef>( NodeRef( p->parent ) );
+				}
+				
+				// Rotate at p as long as p is a separator
+				auto p_sep_type = p->get_sep_type();
+				while( p_sep_type != NOSEP ) {
+					if( p_sep_type == DSEP ) {
+						p_sep_type = R::rotate_dsep( p );
+					}
+					else { // p_sep_type == ISEP
+						assert( p_sep_type == ISEP );
+						p_sep_type = R::rotate_isep( p );
+					}
+					assert( p_sep_type == p->get_sep_type() );
+				}
+				assert( !p->is_separator() );
+				
+				// Now both v and p are NOSEP
+				R::rotate_nosep( v );
+			}
+		}
+	};
+	
+	template<>
+	struct Access<6> : SplitAccess<false> {};
+	
+	template<>
+	struct Access<7> : SplitAccess<true> {};
+	
+	template<>
+	struct Access<8> : WithRotation<Access<6>, BranchlessRotation> {};
+	
+	static const int DEFAULT_VARIANT = 6;
+	
+	template<int Variant>
+	static inline void add_variant( std::vector<NamedImpl>& impls ) {
+		impls.push_back( named_stt_impl<Access<Variant>>( "mtr" + std::to_string( Variant ) ) );
+	}
+	
+	/// Adds all variants as "mtr0" to "mtr8", starting with the default.
+	static inline void add_variants( std::vector<NamedImpl>& impls ) {
+		add_variant<DEFAULT_VARIANT>( impls );
+		add_variant<0>( impls );
+		add_variant<1>( impls );
+		add_variant<2>( impls );
+		add_variant<3>( impls );
+		add_variant<4>( impls );
+		add_variant<5>( impls );
+		add_variant<7>( impls );
+		add_variant<8>( impls );
+	}
+}
+
+using MTRAccessImpl = mtr_stt::Access<mtr_stt::DEFAULT_VARIANT>;
+
+using MTRSTF = stt::STF<MTRAccessImpl>;
+
+#endif
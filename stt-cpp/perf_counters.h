@@ -0,0 +1,67 @@
+#ifndef STT_PERF_COUNTERS_H
+#define STT_PERF_COUNTERS_H
+
+#include <cstdint>
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace stt {
+	/* Hardware event counter of the calling thread (user space only), via perf_event_open. May not be
+	 * available, e.g., in virtual machines or if perf_event_paranoid is too high. */
+	class PerfCounter {
+	public :
+		explicit PerfCounter( uint64_t config ) {
+			perf_event_attr attr;
+			std::memset( &attr, 0, sizeof( attr ) );
+			attr.size = sizeof( attr );
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = config;
+			attr.disabled = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			fd = syscall( __NR_perf_event_open, &attr, 0, -1, -1, 0 );
+		}
+		
+		~PerfCounter() {
+			if( fd >= 0 ) {
+				close( fd );
+			}
+		}
+		
+		PerfCounter( const PerfCounter& ) = delete;
+		PerfCounter& operator=( const PerfCounter& ) = delete;
+		
+		[[nodiscard]] inline bool available() const { return fd >= 0; }
+		
+		void start() {
+			if( fd >= 0 ) {
+				ioctl( fd, PERF_EVENT_IOC_RESET, 0 );
+				ioctl( fd, PERF_EVENT_IOC_ENABLE, 0 );
+			}
+		}
+		
+		void stop() {
+			if( fd >= 0 ) {
+				ioctl( fd, PERF_EVENT_IOC_DISABLE, 0 );
+			}
+		}
+		
+		/// Number of events between start() and stop()
+		[[nodiscard]] uint64_t value() const {
+			uint64_t count = 0;
+			if( fd < 0 || read( fd, &count, sizeof( count ) ) != sizeof( count ) ) {
+				return 0;
+			}
+			return count;
+		}
+		
+	private :
+		int fd;
+	};
+}
+
+#endif
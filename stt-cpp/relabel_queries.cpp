@@ -0,0 +1,24 @@
+#include "parse_input.h"
+
+#include <iostream>
+
+/* Relabels the vertices of a query file for locality (see compute_relabeling()) and writes the
+ * resulting queries to stdout. */
+int main( int argc, const char** argv ) {
+	VertexOrder order;
+	if( argc != 3 || !parse_vertex_order( argv[1], order ) ) {
+		std::cout << "usage: " << argv[0] << " <bfs|dfs|first-touch> <query-file>\n";
+		return 1;
+	}
+	
+	size_t num_vertices;
+	std::vector<Query> queries;
+	if( !read_query_file( argv[2], num_vertices, queries ) ) {
+		std::cerr << "Failed parsing file' " << argv[2] << "'\n";
+		return 2;
+	}
+	
+	relabel_queries( queries, compute_relabeling( num_vertices, queries, order ) );
+	write_query_file( std::cout, num_vertices, queries );
+	return 0;
+}
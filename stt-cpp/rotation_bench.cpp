@@ -0,0 +1,103 @@
+#include <cassert>
+#include <chrono>
+
+#include "parse_input.h"
+
+#include "perf_counters.h"
+#include "stt.h"
+
+/* Microbenchmark for the rotation kernels rotate_dsep(), rotate_isep() and rotate_nosep(): Runs the
+ * link, cut and connectivity queries of a file with the MTR access loop (variant 6 in mtr_stt.h),
+ * which only uses these kernels, once with NSTRotation and once with BranchlessRotation, and reports
+ * the branch misses per query if the hardware counters are available. */
+
+using namespace stt;
+
+struct RotationBenchAccessImpl {
+	typedef NSTRotation Rotation;
+	
+	template<typename R = Rotation, typename NodeRef>
+	static void access( NodeRef v ) {
+		NodeSepType v_sep_type = v->get_sep_type();
+		while( v_sep_type != NOSEP ) {
+			v_sep_type = ( v_sep_type == DSEP ) ? R::rotate_dsep( v ) : R::rotate_isep( v );
+		}
+		while( NodeRef p = v->parent ) {
+			NodeSepType p_sep_type = p->get_sep_type();
+			while( p_sep_type != NOSEP ) {
+				p_sep_type = ( p_sep_type == DSEP ) ? R::rotate_dsep( p ) : R::rotate_isep( p );
+			}
+			R::rotate_nosep( v );
+		}
+	}
+};
+
+template<typename Rotation>
+static bool run( size_t num_vertices, const std::vector<Query>& queries, size_t repeat ) {
+	PerfCounter branches( PERF_COUNT_HW_BRANCH_INSTRUCTIONS );
+	PerfCounter branch_misses( PERF_COUNT_HW_BRANCH_MISSES );
+	
+	int total_cons = 0;
+	auto start = std::chrono::high_resolution_clock::now();
+	branches.start();
+	branch_misses.start();
+	for( size_t i = 0; i < repeat; i++ ) {
+		STF<WithRotation<RotationBenchAccessImpl, Rotation>> f( num_vertices );
+		for( const auto& query : queries ) {
+			if( query.type == LINK ) {
+				f.link( query.arg1, query.arg2 );
+			}
+			else if( query.type == CUT ) {
+				f.cut( query.arg1, query.arg2 );
+			}
+			else if( query.type == PATH ) {
+				total_cons += f.is_connected( query.arg1, query.arg2 );
+			}
+			else {
+				std::cerr << "Cannot execute query '" << query << "'\n";
+				return false;
+			}
+		}
+	}
+	branch_misses.stop();
+	branches.stop();
+	auto duration = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::high_resolution_clock::now() - start );
+	
+	const double num_queries = 1. * repeat * queries.size();
+	std::cout << "Total yes-anwers: " << total_cons / repeat << "\n";
+	std::cout << duration.count() / num_queries << " us/query\n";
+	if( branches.available() && branch_misses.available() ) {
+		std::cout << branches.value() / num_queries << " branches/query\n";
+		std::cout << branch_misses.value() / num_queries << " branch misses/query ("
+				<< 100. * branch_misses.value() / branches.value() << "% of branches)\n";
+	}
+	else {
+		std::cout << "Branch counters not available\n";
+	}
+	return true;
+}
+
+int main( int argc, const char** argv ) {
+	if( argc != 3 ) {
+		std::cout << "usage: " << argv[0] << " <repeat> <query-file>\n";
+		return 1;
+	}
+	size_t repeat = std::atol( argv[1] );
+	
+	size_t num_vertices;
+	std::vector<Query> queries;
+	if( !read_query_file( argv[2], num_vertices, queries ) ) {
+		std::cerr << "Failed parsing file' " << argv[2] << "'\n";
+		return 2;
+	}
+	
+	std::cout << "++ NSTRotation ++\n";
+	if( !run<NSTRotation>( num_vertices, queries, repeat ) ) {
+		return 3;
+	}
+	std::cout << "\n++ BranchlessRotation ++\n";
+	if( !run<BranchlessRotation>( num_vertices, queries, repeat ) ) {
+		return 3;
+	}
+	return 0;
+}
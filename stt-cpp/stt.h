@@ -1,5 +1,23 @@
+#ifndef STT_H
+#define STT_H
+
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "arena.h"
 
 
 #ifdef COUNT_ROTATIONS
@@ -11,48 +29,178 @@ namespace stt {
 		NOSEP, DSEP, ISEP
 	};
 	
-	struct Node {
-		Node* parent;
-		Node* dsep_child;
-		Node* isep_child;
-	
-		void attach( Node* p ) {
-			assert( this->parent == nullptr );
-			this->parent = p;
+	/* Node operations shared by all node representations, using the CRTP.
+	 * Nodes are referred to by handles of type NodeRef, which behave like pointers to Derived: in
+	 * particular, they provide access to the members parent, dsep_child and isep_child, which are
+	 * either plain NodeRefs or link objects that convert from and to NodeRef. By default, NodeRef is
+	 * just Derived*; other handle types must be provided by Derived::ref(). */
+	template<typename Derived, typename NodeRef = Derived*>
+	struct NodeBase {
+		Derived* ref() const { return const_cast<Derived*>( static_cast<const Derived*>( this ) ); }
+		
+		NodeRef self() const { return static_cast<const Derived*>( this )->ref(); }
+		
+		/* Node types that keep their own NodeSepType (e.g., TaggedNode) set this to true and hide
+		 * stored_sep_type() and set_sep_type(). The rotations then keep the stored type up to date,
+		 * and the separator queries below read it instead of probing the parent. */
+		static const bool STORES_SEP_TYPE = false;
+		
+		[[nodiscard]] NodeSepType stored_sep_type() const { return NOSEP; }
+		
+		void set_sep_type( NodeSepType ) {}
+		
+		void attach( NodeRef p ) {
+			assert( self()->parent == nullptr );
+			self()->parent = p;
+			p->add_child_subtree( self() );
+			// Roots and non-separator children both have type NOSEP, so the stored type stays valid
+			assert( this->get_sep_type() == NOSEP );
 		}
 	
 		void detach() {
-			assert( this->parent != nullptr && !this->is_separator_hint( this->parent ) );
-			this->parent = nullptr;
+			assert( self()->parent != nullptr && !this->is_separator_hint( self()->parent ) );
+			self()->parent->remove_child_subtree( self() );
+			self()->parent = nullptr;
+			assert( this->get_sep_type() == NOSEP );
 		}
 		
 		[[nodiscard]] NodeSepType get_sep_type() const {
-			Node* p = this->parent;
-			if( p ) {
-				if( p->dsep_child == this ) { return DSEP; }
-				else if( p->isep_child == this ) { return ISEP; }
+			NodeRef p = self()->parent;
+			if( Derived::STORES_SEP_TYPE ) {
+				assert( !p || self()->stored_sep_type() == probe_sep_type( p ) );
+				return self()->stored_sep_type();
 			}
-			return NOSEP;
+			return p ? probe_sep_type( p ) : NOSEP;
 		}
 		
-		[[nodiscard]] NodeSepType get_sep_type_hint( Node* p ) const {
-			if( p->dsep_child == this ) { return DSEP; }
-			else if( p->isep_child == this ) { return ISEP; }
+		template<bool Branchless = false>
+		[[nodiscard]] NodeSepType get_sep_type_hint( NodeRef p ) const {
+			if( Derived::STORES_SEP_TYPE ) {
+				assert( self()->stored_sep_type() == probe_sep_type( p ) );
+				return self()->stored_sep_type();
+			}
+			return probe_sep_type<Branchless>( p );
+		}
+		
+		/* Determines the separator type by looking at the parent p. The kernels with Branchless set
+		 * (see BranchlessRotation) compute it from both comparisons instead of branching on them. */
+		template<bool Branchless = false>
+		[[nodiscard]] NodeSepType probe_sep_type( NodeRef p ) const {
+			if( Branchless ) {
+				return NodeSepType( ( NodeRef( p->dsep_child ) == self() ) * DSEP | ( NodeRef( p->isep_child ) == self() ) * ISEP );
+			}
+			if( p->dsep_child == self() ) { return DSEP; }
+			else if( p->isep_child == self() ) { return ISEP; }
 			else { return NOSEP; }
 		}
-
-#ifdef ROT_IMPROVED
-		inline bool rotate() { // Returns whether this is a separator after the rotation
+		
+		/// Replaces the separator child of g with the given type (if not NOSEP) by v.
+		template<bool Branchless = false>
+		static inline void replace_sep_child( NodeRef g, const NodeSepType type, NodeRef v ) {
+			if( Branchless ) {
+				// Write both links unconditionally, so that the compiler can use conditional moves
+				g->dsep_child = ( type == DSEP ) ? v : NodeRef( g->dsep_child );
+				g->isep_child = ( type == ISEP ) ? v : NodeRef( g->isep_child );
+			}
+			else if( type == DSEP ) {
+				g->dsep_child = v;
+			}
+			else if( type == ISEP ) {
+				g->isep_child = v;
+			}
+		}
+		
+		/// Stores the separator type t in x (if not null), for node types with STORES_SEP_TYPE.
+		static inline void store_sep_type( NodeRef x, NodeSepType t ) {
+			if( Derived::STORES_SEP_TYPE && x ) {
+				x->set_sep_type( t );
+			}
+		}
+		
+		/* Node types that maintain an aggregate over their separator descendants (e.g.,
+		 * AggregateNode) set this to true and hide update_aggregate(), which recomputes it from the
+		 * node and its separator children. Rotations call it for each node whose separator children
+		 * changed, bottom-up. Swapping the separator children does not change the aggregate, so it
+		 * must be commutative. */
+		static const bool HAS_AGGREGATE = false;
+		
+		void update_aggregate() {}
+		
+		/// Copies the data of v that is not derived from other nodes (see STF::relayout()).
+		void copy_payload( NodeRef ) {}
+		
+		/* Recomputes the data derived from the children, which have been rebuilt before, and adds
+		 * this node to the data of its parent where needed. Called bottom-up for all nodes by
+		 * STF::relayout() and STF::build(). */
+		void rebuild_payload() {
+			refresh_aggregate( self() );
+		}
+		
+		/// Resets the data that rebuild_payload() adds to, before STF::rebuild().
+		void clear_derived_payload() {}
+		
+		static inline void refresh_aggregate( NodeRef x ) {
+			if( Derived::HAS_AGGREGATE ) {
+				x->update_aggregate();
+			}
+		}
+		
+		/* Node types with lazy updates of their separator descendants (e.g., AddNode) set this to
+		 * true and hide push_down(), which applies the pending update to the separator children.
+		 * Rotations call it top-down for each node whose separator children change. */
+		static const bool HAS_LAZY_UPDATES = false;
+		
+		void push_down() {}
+		
+		static inline void push_lazy( NodeRef x ) {
+			if( Derived::HAS_LAZY_UPDATES ) {
+				x->push_down();
+			}
+		}
+		
+		/* Node types with data that depends on the vertex set of their search subtree, like the weight
+		 * of the edge to their parent (see EdgeAggregateNode) or the subtree size (see SizeNode), hide
+		 * move_subtree_data(). The rotations call it when this node is rotated above p, where c is
+		 * this node's dsep child before the rotation, which becomes a child of p. Afterwards, the
+		 * subtree of this node has the vertices that p's had before. */
+		static const bool HAS_EDGE_WEIGHTS = false;
+		static const bool HAS_SUBTREE_SIZE = false;
+		static const bool HAS_MARKS = false;
+		
+		void move_subtree_data( NodeRef /*p*/, NodeRef /*c*/ ) {}
+		
+		/* Node types that keep aggregates of their non-separator children (see
+		 * ComponentAggregateNode) set this to true and hide prepare_rotation(), which the rotations
+		 * call before this node is rotated above p. The fused splay step then falls back to two
+		 * rotations, since the non-separator children change in between. */
+		static const bool HAS_COMPONENT_AGGREGATE = false;
+		
+		void prepare_rotation( NodeRef /*p*/ ) {}
+		
+		/* Called by attach() and detach() on the new or old parent, which is a search tree root.
+		 * Node types with subtree sizes or aggregates (see SizeNode) hide them. */
+		void add_child_subtree( NodeRef ) {}
+		
+		void remove_child_subtree( NodeRef ) {}
+		
+		static inline void count_rotations( size_t k ) {
 #ifdef COUNT_ROTATIONS
-			num_rotations++;
+			num_rotations += k;
 #endif
-			assert( this->parent != nullptr );
-			assert( this->is_separator() || !this->parent->is_separator() );
+		}
+
+		inline bool rotate_improved() { // Returns whether this is a separator after the rotation
+			count_rotations( 1 );
+			assert( self()->parent != nullptr );
+			assert( this->is_separator() || !self()->parent->is_separator() );
 			
-			Node* v = this;
-			Node* p = v->parent;
-			Node* g = p->parent;
-			Node* c = v->dsep_child;
+			NodeRef v = self();
+			NodeRef p = v->parent;
+			NodeRef g = p->parent;
+			NodeRef c = v->dsep_child;
+			push_lazy( p );
+			push_lazy( v );
+			v->prepare_rotation( p );
 			
 			// Change parents
 			v->parent = g;
@@ -61,43 +209,50 @@ namespace stt {
 			// Changes related to c
 			if( c ) {
 				c->parent = p;
-				std::swap( c->dsep_child, c->isep_child );
+				c->swap_sep_children();
 			}
 			
 			bool p_was_sep = false;
 			// Change separator information for children of v and g
 			if( g ) { // p was not root
-				Node* old_p_dsep_child = p->dsep_child;
+				NodeRef old_p_dsep_child = p->dsep_child;
 				
 				// Change isep_child of p (stays null if p is the root)
 				if( old_p_dsep_child && old_p_dsep_child != v ) {
 					p->isep_child = old_p_dsep_child;
+					store_sep_type( old_p_dsep_child, ISEP );
 				}
 				else if( p->isep_child == v ) {
 					p->isep_child = nullptr;
 				}
 				
-				if( p == g->dsep_child ) {
+				NodeSepType p_type = p->get_sep_type_hint( g );
+				if( p_type == DSEP ) {
 					p_was_sep = true;
 					g->dsep_child = v;
 				}
-				else if( p == g->isep_child ) {
+				else if( p_type == ISEP ) {
 					p_was_sep = true;
 					g->isep_child = v;
 				}
+				store_sep_type( v, p_type );
 				
 				if( old_p_dsep_child != v ) {
 					// p separates v and g
 					v->dsep_child = p;
+					store_sep_type( p, DSEP );
 				}
 				else {
 					// v separates p and g
 					v->dsep_child = v->isep_child;
+					store_sep_type( v->dsep_child, DSEP );
 					if( p_was_sep ) {
 						v->isep_child = p;
+						store_sep_type( p, ISEP );
 					}
 					else {
 						v->isep_child = nullptr;
+						store_sep_type( p, NOSEP );
 					}
 				}
 			}
@@ -108,21 +263,26 @@ namespace stt {
 			// Change dsep child of p
 			p->dsep_child = c;
 			
+			v->move_subtree_data( p, c );
+			refresh_aggregate( p );
+			refresh_aggregate( v );
+			
 			return p_was_sep;
 		}
 		
-#elif defined( ROT_NST )
-		inline NodeSepType rotate() { // Returns separator type after the rotation
-#ifdef COUNT_ROTATIONS
-			num_rotations++;
-#endif
-			assert( this->parent != nullptr );
-			assert( this->is_separator() || !this->parent->is_separator() );
+		template<bool Branchless = false>
+		inline NodeSepType rotate_nst() { // Returns separator type after the rotation
+			count_rotations( 1 );
+			assert( self()->parent != nullptr );
+			assert( this->is_separator() || !self()->parent->is_separator() );
 			
-			Node* v = this;
-			Node* p = v->parent;
-			Node* g = p->parent;
-			Node* c = v->dsep_child;
+			NodeRef v = self();
+			NodeRef p = v->parent;
+			NodeRef g = p->parent;
+			NodeRef c = v->dsep_child;
+			push_lazy( p );
+			push_lazy( v );
+			v->prepare_rotation( p );
 			
 			// Change parents
 			v->parent = g;
@@ -131,43 +291,43 @@ namespace stt {
 			// Changes related to c
 			if( c ) {
 				c->parent = p;
-				std::swap( c->dsep_child, c->isep_child );
+				c->swap_sep_children();
 			}
 			
 			NodeSepType p_type = NOSEP;
 			// Change separator information for children of v and g
 			if( g ) { // p was not root
-				Node* old_p_dsep_child = p->dsep_child;
+				NodeRef old_p_dsep_child = p->dsep_child;
 				
 				// Change isep_child of p (stays null if p is the root)
 				if( old_p_dsep_child && old_p_dsep_child != v ) {
 					p->isep_child = old_p_dsep_child;
+					store_sep_type( old_p_dsep_child, ISEP );
 				}
 				else if( p->isep_child == v ) {
 					p->isep_child = nullptr;
 				}
 				
-				if( p == g->dsep_child ) {
-					p_type = DSEP;
-					g->dsep_child = v;
-				}
-				else if( p == g->isep_child ) {
-					p_type = ISEP;
-					g->isep_child = v;
-				}
+				p_type = p->template get_sep_type_hint<Branchless>( g );
+				replace_sep_child<Branchless>( g, p_type, v );
+				store_sep_type( v, p_type );
 				
 				if( old_p_dsep_child != v ) {
 					// p separates v and g
 					v->dsep_child = p;
+					store_sep_type( p, DSEP );
 				}
 				else {
 					// v separates p and g
 					v->dsep_child = v->isep_child;
+					store_sep_type( v->dsep_child, DSEP );
 					if( p_type != NOSEP ) {
 						v->isep_child = p;
+						store_sep_type( p, ISEP );
 					}
 					else {
 						v->isep_child = nullptr;
+						store_sep_type( p, NOSEP );
 					}
 				}
 			}
@@ -178,20 +338,26 @@ namespace stt {
 			// Change dsep child of p
 			p->dsep_child = c;
 			
+			v->move_subtree_data( p, c );
+			refresh_aggregate( p );
+			refresh_aggregate( v );
+			
 			return p_type;
 		}
 		
+		template<bool Branchless = false>
 		inline NodeSepType rotate_dsep() { // Returns separator type after the rotation
-#ifdef COUNT_ROTATIONS
-			num_rotations++;
-#endif
-			assert( this->parent != nullptr );
-			assert( this->parent->dsep_child == this );
+			count_rotations( 1 );
+			assert( self()->parent != nullptr );
+			assert( self()->parent->dsep_child == self() );
 			
-			Node* v = this;
-			Node* p = v->parent;
-			Node* g = p->parent;
-			Node* c = v->dsep_child;
+			NodeRef v = self();
+			NodeRef p = v->parent;
+			NodeRef g = p->parent;
+			NodeRef c = v->dsep_child;
+			push_lazy( p );
+			push_lazy( v );
+			v->prepare_rotation( p );
 			
 			assert( g ); // this is dsep, so p is not the root.
 			
@@ -202,46 +368,53 @@ namespace stt {
 			// Changes related to c
 			if( c ) {
 				c->parent = p;
-				std::swap( c->dsep_child, c->isep_child );
+				c->swap_sep_children();
 			}
 			
-			NodeSepType p_type = NOSEP;
 			// Change separator information for children of v and g
-			if( p == g->dsep_child ) {
-				p_type = DSEP;
-				g->dsep_child = v;
-			}
-			else if( p == g->isep_child ) {
-				p_type = ISEP;
-				g->isep_child = v;
-			}
+			NodeSepType p_type = p->template get_sep_type_hint<Branchless>( g );
+			replace_sep_child<Branchless>( g, p_type, v );
+			store_sep_type( v, p_type );
 			
 			// v separates p and g
 			v->dsep_child = v->isep_child;
-			if( p_type != NOSEP ) {
+			store_sep_type( v->dsep_child, DSEP );
+			if( Branchless ) {
+				v->isep_child = ( p_type != NOSEP ) ? p : NodeRef();
+				store_sep_type( p, ( p_type != NOSEP ) ? ISEP : NOSEP );
+			}
+			else if( p_type != NOSEP ) {
 				v->isep_child = p;
+				store_sep_type( p, ISEP );
 			}
 			else {
 				v->isep_child = nullptr;
+				store_sep_type( p, NOSEP );
 			}
 			
 			// Change dsep child of p
 			p->dsep_child = c;
 			
+			v->move_subtree_data( p, c );
+			refresh_aggregate( p );
+			refresh_aggregate( v );
+			
 			return p_type;
 		}
 		
+		template<bool Branchless = false>
 		inline NodeSepType rotate_isep() { // Returns separator type after the rotation
-#ifdef COUNT_ROTATIONS
-			num_rotations++;
-#endif
-			assert( this->parent != nullptr );
-			assert( this->parent->isep_child == this );
+			count_rotations( 1 );
+			assert( self()->parent != nullptr );
+			assert( self()->parent->isep_child == self() );
 			
-			Node* v = this;
-			Node* p = v->parent;
-			Node* g = p->parent;
-			Node* c = v->dsep_child;
+			NodeRef v = self();
+			NodeRef p = v->parent;
+			NodeRef g = p->parent;
+			NodeRef c = v->dsep_child;
+			push_lazy( p );
+			push_lazy( v );
+			v->prepare_rotation( p );
 			
 			assert( g ); // this is isep, so p is not the root.
 			
@@ -252,46 +425,48 @@ namespace stt {
 			// Changes related to c
 			if( c ) {
 				c->parent = p;
-				std::swap( c->dsep_child, c->isep_child );
+				c->swap_sep_children();
 			}
 			
 			// Change separator information for children of v and g
-			NodeSepType p_type = NOSEP;
-			Node* old_p_dsep_child = p->dsep_child;
+			NodeRef old_p_dsep_child = p->dsep_child;
 			
 			// Change isep_child of p (stays null if p is the root)
 			p->isep_child = old_p_dsep_child;
+			store_sep_type( old_p_dsep_child, ISEP );
 			
-			if( p == g->dsep_child ) {
-				p_type = DSEP;
-				g->dsep_child = v;
-			}
-			else if( p == g->isep_child ) {
-				p_type = ISEP;
-				g->isep_child = v;
-			}
+			NodeSepType p_type = p->template get_sep_type_hint<Branchless>( g );
+			replace_sep_child<Branchless>( g, p_type, v );
+			store_sep_type( v, p_type );
 			
 			// We know that p separates v and g
 			v->dsep_child = p;
+			store_sep_type( p, DSEP );
 			
 			// Change dsep child of p
 			p->dsep_child = c;
 			
+			v->move_subtree_data( p, c );
+			refresh_aggregate( p );
+			refresh_aggregate( v );
+			
 			return p_type;
 		}
 		
+		template<bool Branchless = false>
 		inline NodeSepType rotate_nosep() { // Returns separator type after the rotation
-#ifdef COUNT_ROTATIONS
-			num_rotations++;
-#endif
-			assert( this->parent != nullptr );
-			assert( !this->is_separator() && !this->parent->is_separator() );
-			assert( this->isep_child == nullptr );
+			count_rotations( 1 );
+			assert( self()->parent != nullptr );
+			assert( !this->is_separator() && !self()->parent->is_separator() );
+			assert( self()->isep_child == nullptr );
 			
-			Node* v = this;
-			Node* p = v->parent;
-			Node* g = p->parent;
-			Node* c = v->dsep_child;
+			NodeRef v = self();
+			NodeRef p = v->parent;
+			NodeRef g = p->parent;
+			NodeRef c = v->dsep_child;
+			push_lazy( p );
+			push_lazy( v );
+			v->prepare_rotation( p );
 			
 			// Change parents
 			v->parent = g;
@@ -300,22 +475,28 @@ namespace stt {
 			// Changes related to c
 			if( c ) {
 				c->parent = p;
-				std::swap( c->dsep_child, c->isep_child );
+				c->swap_sep_children();
 			}
 			
 			// Change separator information for children of v and g
 			if( g ) { // p was not root
-				Node* old_p_dsep_child = p->dsep_child;
+				NodeRef old_p_dsep_child = p->dsep_child;
 				
 				// Change isep_child of p (stays null if p is the root)
-				if( old_p_dsep_child ) {
+				if( Branchless ) {
+					p->isep_child = old_p_dsep_child; // p is not a separator, so its isep child was null
+					store_sep_type( old_p_dsep_child, ISEP );
+				}
+				else if( old_p_dsep_child ) {
 					p->isep_child = old_p_dsep_child;
+					store_sep_type( old_p_dsep_child, ISEP );
 				}
 				
 				// p cannot be a separator child of g (otherwise rotation wouldn't be valid)
 				
 				// We know that p separates v and g
 				v->dsep_child = p;
+				store_sep_type( p, DSEP );
 			}
 			else { // p was root
 				v->dsep_child = nullptr;
@@ -324,32 +505,166 @@ namespace stt {
 			// Change dsep child of p
 			p->dsep_child = c;
 			
+			v->move_subtree_data( p, c );
+			refresh_aggregate( p );
+			refresh_aggregate( v );
+			
 			return NOSEP;
 		}
 		
+		template<bool Branchless = false>
 		inline NodeSepType rotate_type_hint( const NodeSepType type ) {
 			if( type == DSEP ) {
-				return rotate_dsep();
+				return rotate_dsep<Branchless>();
 			}
 			else if( type == ISEP ) {
-				return rotate_isep();
+				return rotate_isep<Branchless>();
 			}
 			else {
-				return rotate_nosep();
+				return rotate_nosep<Branchless>();
 			}
 		}
-#else
-		void rotate() {
-#ifdef COUNT_ROTATIONS
-			num_rotations++;
-#endif
-			assert( this->parent != nullptr );
-			assert( this->is_separator() || !this->parent->is_separator() );
+		
+		/* Splay step at this node v, with parent p and grandparent g, given the separator types of v
+		 * and p. Has the same effect as rotating twice at v if v is the dsep child of p, and otherwise
+		 * at p and then at v (see UnfusedRotation), but computes the final configuration directly, so
+		 * each link is written at most once. */
+		template<bool Branchless = false>
+		inline void splay_step_fused( const NodeSepType v_type, NodeRef p, const NodeSepType p_type ) {
+			if( Derived::HAS_COMPONENT_AGGREGATE ) {
+				if( v_type == DSEP ) {
+					rotate_dsep<Branchless>();
+					rotate_type_hint<Branchless>( p_type );
+				}
+				else {
+					p->template rotate_type_hint<Branchless>( p_type );
+					rotate_nst<Branchless>();
+				}
+				return;
+			}
+			count_rotations( 2 );
+			NodeRef v = self();
+			assert( p == v->parent && p->parent != nullptr );
+			assert( v_type == v->get_sep_type_hint( p ) && p_type == p->get_sep_type_hint( p->parent ) );
+			
+			NodeRef g = p->parent;
+			NodeRef gg = g->parent;
+			NodeRef vd = v->dsep_child;
+			NodeRef vi = v->isep_child;
+			NodeRef pd = p->dsep_child;
+			NodeRef gd = g->dsep_child;
+			push_lazy( g );
+			push_lazy( p );
+			push_lazy( v );
+			
+			// v takes the place of g
+			NodeSepType g_type = NOSEP;
+			if( gg ) {
+				g_type = g->template get_sep_type_hint<Branchless>( gg );
+				replace_sep_child<Branchless>( gg, g_type, v );
+			}
+			assert( ( v_type != NOSEP && p_type != NOSEP ) || g_type == NOSEP );
+			v->parent = gg;
+			store_sep_type( v, g_type );
+			
+			// In both cases, p ends up as child of v, with v's dsep child as its dsep child
+			p->parent = v;
+			p->dsep_child = vd;
+			if( vd ) {
+				vd->parent = p;
+				vd->swap_sep_children();
+			}
+			
+			if( v_type == DSEP ) {
+				// Rotating at v twice: g ends up as child of v, with v's isep child as its dsep child
+				g->parent = v;
+				g->dsep_child = vi;
+				if( vi ) {
+					vi->parent = g;
+					vi->swap_sep_children();
+					store_sep_type( vi, DSEP );
+				}
+				
+				if( p_type == DSEP ) {
+					v->dsep_child = p;
+					v->isep_child = ( g_type != NOSEP ) ? g : nullptr;
+					store_sep_type( g, ( g_type != NOSEP ) ? ISEP : NOSEP );
+				}
+				else if( p_type == ISEP ) {
+					v->dsep_child = g;
+					v->isep_child = p;
+					g->isep_child = gd;
+					store_sep_type( g, DSEP );
+					store_sep_type( gd, ISEP );
+				}
+				else { // p and g are not separators
+					v->dsep_child = gg ? g : nullptr;
+					v->isep_child = nullptr;
+					g->isep_child = gd;
+					store_sep_type( g, gg ? DSEP : NOSEP );
+					store_sep_type( gd, ISEP );
+				}
+			}
+			else {
+				// Rotating at p, then at v: g ends up as child of p, with p's dsep child as its dsep child
+				g->parent = p;
+				g->dsep_child = pd;
+				if( pd ) {
+					pd->parent = g;
+					pd->swap_sep_children();
+				}
+				
+				if( p_type == DSEP && v_type == ISEP ) {
+					v->dsep_child = vi;
+					v->isep_child = ( g_type != NOSEP ) ? p : nullptr;
+					p->isep_child = ( g_type != NOSEP ) ? g : nullptr;
+					store_sep_type( vi, DSEP );
+					store_sep_type( p, ( g_type != NOSEP ) ? ISEP : NOSEP );
+					store_sep_type( g, ( g_type != NOSEP ) ? ISEP : NOSEP );
+				}
+				else if( p_type == DSEP ) { // v is not a separator, so neither is g
+					v->dsep_child = p;
+				}
+				else if( gg ) { // p is the isep child of g, or both are not separators
+					v->dsep_child = p;
+					p->isep_child = g;
+					g->isep_child = gd;
+					store_sep_type( p, DSEP );
+					store_sep_type( g, ISEP );
+					store_sep_type( gd, ISEP );
+				}
+				else { // v and p are not separators and g is the root
+					v->dsep_child = nullptr;
+				}
+			}
 			
-			Node* v = this;
-			Node* p = v->parent;
-			Node* g = p->parent;
-			Node* c = v->dsep_child;
+			if( v_type == DSEP ) {
+				v->move_subtree_data( p, vd );
+				v->move_subtree_data( g, vi );
+			}
+			else {
+				p->move_subtree_data( g, pd );
+				v->move_subtree_data( p, vd );
+			}
+			
+			// g and p are children of v, or g is a child of p
+			refresh_aggregate( g );
+			refresh_aggregate( p );
+			refresh_aggregate( v );
+		}
+		
+		inline void rotate_basic() {
+			count_rotations( 1 );
+			assert( self()->parent != nullptr );
+			assert( this->is_separator() || !self()->parent->is_separator() );
+			
+			NodeRef v = self();
+			NodeRef p = v->parent;
+			NodeRef g = p->parent;
+			NodeRef c = v->dsep_child;
+			push_lazy( p );
+			push_lazy( v );
+			v->prepare_rotation( p );
 			
 			// Change parents
 			v->parent = g;
@@ -359,21 +674,24 @@ namespace stt {
 			// Change separator information for children of gp
 			bool p_was_sep = false;
 			if( g ) {
-				if( p == g->dsep_child ) {
+				NodeSepType p_type = p->get_sep_type_hint( g );
+				if( p_type == DSEP ) {
 					p_was_sep = true;
 					g->dsep_child = v;
 				}
-				else if( p == g->isep_child ) {
+				else if( p_type == ISEP ) {
 					p_was_sep = true;
 					g->isep_child = v;
 				}
+				store_sep_type( v, p_type );
 			}
 			
 			// Change separator information for children of p
-			Node* old_p_dsep_child = p->dsep_child;
+			NodeRef old_p_dsep_child = p->dsep_child;
 			p->dsep_child = c;
 			if( old_p_dsep_child && old_p_dsep_child != v ) {
 				p->isep_child = old_p_dsep_child;
+				store_sep_type( old_p_dsep_child, ISEP );
 			}
 			else if( p->isep_child == v ) {
 				p->isep_child = nullptr;
@@ -384,15 +702,19 @@ namespace stt {
 				if( old_p_dsep_child != v ) {
 					// p separates v and g
 					v->dsep_child = p;
+					store_sep_type( p, DSEP );
 				}
 				else {
 					// v separates p and g
 					v->dsep_child = v->isep_child;
+					store_sep_type( v->dsep_child, DSEP );
 					if( p_was_sep ) {
 						v->isep_child = p;
+						store_sep_type( p, ISEP );
 					}
 					else {
 						v->isep_child = nullptr;
+						store_sep_type( p, NOSEP );
 					}
 				}
 			}
@@ -402,21 +724,38 @@ namespace stt {
 			
 			// Change separator information for children of c (not affected by the rotation otherwise)
 			if( c ) {
-				std::swap( c->dsep_child, c->isep_child );
+				c->swap_sep_children();
 			}
+			
+			v->move_subtree_data( p, c );
+			refresh_aggregate( p );
+			refresh_aggregate( v );
+		}
+		
+		void swap_sep_children() {
+			NodeRef c = self()->dsep_child;
+			self()->dsep_child = self()->isep_child;
+			self()->isep_child = c;
+			store_sep_type( self()->dsep_child, DSEP );
+			store_sep_type( c, ISEP );
 		}
-#endif
 		
-		bool is_separator_hint( Node* p ) {
-			return p->dsep_child == this || p->isep_child == this;
+		bool is_separator_hint( NodeRef p ) {
+			if( Derived::STORES_SEP_TYPE ) {
+				return this->get_sep_type_hint( p ) != NOSEP;
+			}
+			return p->dsep_child == self() || p->isep_child == self();
 		}
 		
 		bool is_separator() {
-			return this->parent && this->is_separator_hint( this->parent );
+			if( Derived::STORES_SEP_TYPE ) {
+				return this->get_sep_type() != NOSEP;
+			}
+			return self()->parent && this->is_separator_hint( self()->parent );
 		}
 		
-		Node* get_stt_root() {
-			Node* v = this;
+		NodeRef get_stt_root() {
+			NodeRef v = self();
 			while( v->parent ) {
 				v = v->parent;
 			}
@@ -424,131 +763,2694 @@ namespace stt {
 		}
 	};
 	
+
+	struct Node : NodeBase<Node> {
+		Node* parent;
+		Node* dsep_child;
+		Node* isep_child;
+	};
+	
+	
+	/// Number of low bits of a node address that are free to store a NodeSepType
+	static const unsigned SEP_TYPE_TAG_BITS = 2;
+	
+	/// Pointer to N that keeps a NodeSepType in its lowest bits.
+	template<typename N>
+	class TaggedLink {
+	public :
+		static const uintptr_t TAG_MASK = ( uintptr_t( 1 ) << SEP_TYPE_TAG_BITS ) - 1;
+		
+		inline operator N*() const { return reinterpret_cast<N*>( bits & ~TAG_MASK ); }
+		
+		inline N* operator->() const { return *this; }
+		
+		/// Changes the target, keeping the tag.
+		inline TaggedLink& operator=( N* v ) {
+			assert( ( reinterpret_cast<uintptr_t>( v ) & TAG_MASK ) == 0 );
+			bits = reinterpret_cast<uintptr_t>( v ) | ( bits & TAG_MASK );
+			return *this;
+		}
+		
+		[[nodiscard]] inline NodeSepType tag() const { return NodeSepType( bits & TAG_MASK ); }
+		
+		inline void set_tag( NodeSepType t ) { bits = ( bits & ~TAG_MASK ) | t; }
+		
+	private :
+		uintptr_t bits;
+	};
+	
+	/* Like Node, but stores its own NodeSepType in the parent pointer, so determining the separator
+	 * type does not require loading the parent. In return, rotations have to update the types of the
+	 * nodes whose role changes, including the children of the rotated node's dsep child. */
+	struct TaggedNode : NodeBase<TaggedNode> {
+		static const bool STORES_SEP_TYPE = true;
+		
+		TaggedLink<TaggedNode> parent;
+		TaggedNode* dsep_child;
+		TaggedNode* isep_child;
+		
+		[[nodiscard]] inline NodeSepType stored_sep_type() const { return parent.tag(); }
+		
+		inline void set_sep_type( NodeSepType t ) { parent.set_tag( t ); }
+	};
 	
 	
-	// Splay-related stuff
-	static inline void splay_step( Node* v ) {
-		Node* p = v->parent;
-		if( p->dsep_child == v ) {
-			v->rotate();
+	
+	// Aggregates
+	
+	/* Aggregates for AggregateNode: a Value type with a neutral element and a commutative combine().
+	 * For ComponentAggregateNode, an aggregate also needs a Multiset of values that supports removal
+	 * and returns the aggregate of its elements with get(). */
+	template<typename T>
+	struct MinAggregate {
+		typedef T Value;
+		static inline T identity() { return std::numeric_limits<T>::max(); }
+		static inline T combine( T a, T b ) { return a < b ? a : b; }
+		
+		struct Multiset {
+			std::multiset<T> values;
+			void insert( T x ) { values.insert( x ); }
+			void erase( T x ) { values.erase( values.find( x ) ); }
+			T get() const { return values.empty() ? identity() : *values.begin(); }
+		};
+	};
+	
+	template<typename T>
+	struct MaxAggregate {
+		typedef T Value;
+		static inline T identity() { return std::numeric_limits<T>::lowest(); }
+		static inline T combine( T a, T b ) { return a < b ? b : a; }
+		
+		struct Multiset {
+			std::multiset<T> values;
+			void insert( T x ) { values.insert( x ); }
+			void erase( T x ) { values.erase( values.find( x ) ); }
+			T get() const { return values.empty() ? identity() : *values.rbegin(); }
+		};
+	};
+	
+	template<typename T>
+	struct SumAggregate {
+		typedef T Value;
+		static inline T identity() { return T(); }
+		static inline T combine( T a, T b ) { return a + b; }
+		
+		// Sums can be subtracted, so only the total is needed
+		struct Multiset {
+			T total = T();
+			void insert( T x ) { total += x; }
+			void erase( T x ) { total -= x; }
+			T get() const { return total; }
+		};
+	};
+	
+	/* Node with a weight that also keeps the aggregate of the weights of its separator descendants,
+	 * including itself. The separator descendants of a node are exactly the vertices on the path
+	 * between its boundary vertices, which gives path aggregates (see STF::path_aggregate()).
+	 * 
+	 * With EdgeWeights, the weight is instead that of the edge between the subtree of the node and
+	 * its parent (meaningless for roots). Then the aggregate of a separator covers the edges on the
+	 * path between its boundary vertices, except the edge to its indirect boundary vertex (see
+	 * STF::path_edge_aggregate()). */
+	template<typename A, bool EdgeWeights = false>
+	struct AggregateNode : NodeBase<AggregateNode<A, EdgeWeights>> {
+		typedef A Aggregate;
+		typedef typename A::Value Value;
+		
+		static const bool HAS_AGGREGATE = true;
+		static const bool HAS_EDGE_WEIGHTS = EdgeWeights;
+		
+		AggregateNode* parent;
+		AggregateNode* dsep_child;
+		AggregateNode* isep_child;
+		
+		Value weight = Value();
+		Value aggregate = Value();
+		
+		inline void update_aggregate() {
+			Value a = weight;
+			if( dsep_child ) {
+				a = A::combine( a, dsep_child->aggregate );
+			}
+			if( isep_child ) {
+				a = A::combine( a, isep_child->aggregate );
+			}
+			aggregate = a;
 		}
-		else if( p->parent ) {
-			p->rotate();
+		
+		inline void copy_payload( const AggregateNode* v ) {
+			weight = v->weight;
 		}
-		v->rotate();
-	}
+		
+		inline void move_subtree_data( AggregateNode* p, AggregateNode* c ) {
+			if( EdgeWeights ) {
+				// The subtree of this node takes the place of p's, so it gets p's edge
+				Value w = weight;
+				weight = p->weight;
+				if( c ) {
+					// p's new subtree is joined to this node via c, and c's subtree to p
+					p->weight = c->weight;
+					c->weight = w;
+					c->update_aggregate();
+				}
+				else {
+					p->weight = w;
+				}
+			}
+		}
+	};
 	
-	static inline void splay_step_full( Node* v, Node* p ) {
-		if( p->dsep_child == v ) {
-			v->rotate();
+	/* Node with a weight that supports adding a value to all vertices on a path, and keeps the sum
+	 * and minimum of the weights of its separator descendants (see STF::path_add()). Additions to
+	 * the separator descendants of a node are applied to the node itself, and kept in pending until
+	 * they are pushed down to its separator children. */
+	template<typename T>
+	struct AddNode : NodeBase<AddNode<T>> {
+		typedef T Value;
+		
+		static const bool HAS_AGGREGATE = true;
+		static const bool HAS_LAZY_UPDATES = true;
+		
+		AddNode* parent;
+		AddNode* dsep_child;
+		AddNode* isep_child;
+		
+		T weight = T();
+		T sum = T();
+		T min = T();
+		size_t size = 1; // Number of separator descendants
+		T pending = T();
+		
+		/// Adds delta to the weights of all separator descendants.
+		inline void add( T delta ) {
+			weight += delta;
+			sum += delta * T( size );
+			min += delta;
+			pending += delta;
 		}
-		else {
-			p->rotate();
+		
+		inline void push_down() {
+			if( pending != T() ) {
+				if( dsep_child ) {
+					dsep_child->add( pending );
+				}
+				if( isep_child ) {
+					isep_child->add( pending );
+				}
+				pending = T();
+			}
 		}
-		v->rotate();
-	}
-	
-#ifdef ROT_NST
-	static inline void splay_step_type_hint( Node* v, const NodeSepType v_type, Node* p, const NodeSepType p_type ) {
-		if( v_type == DSEP ) {
-			v->rotate_dsep();
-			v->rotate_type_hint( p_type );
+		
+		inline void update_aggregate() {
+			sum = weight;
+			min = weight;
+			size = 1;
+			if( dsep_child ) {
+				combine_child( dsep_child );
+			}
+			if( isep_child ) {
+				combine_child( isep_child );
+			}
 		}
-		else {
-			p->rotate_type_hint( p_type );
-			v->rotate();
+		
+		// The values of the separator children do not include the pending addition yet
+		inline void combine_child( const AddNode* c ) {
+			sum += c->sum + pending * T( c->size );
+			if( c->min + pending < min ) {
+				min = c->min + pending;
+			}
+			size += c->size;
 		}
-	}
-#endif
-	
-	static inline bool can_splay_step( Node* v ) {
-		Node* p = v->parent;
-		assert( p );
-		Node* g = p->parent;
-		return !g || !g->is_separator() || ( v->is_separator_hint( p ) && p->is_separator_hint( g ) );
-	}
-	
+		
+		inline void copy_payload( const AddNode* v ) {
+			weight = v->weight;
+			pending = v->pending;
+		}
+	};
 	
-	// Forward declarations
-	template<typename AccessImpl>
-	class STF;
-	template<typename AccessImpl>
-	std::ostream& operator<<( std::ostream& os, STF<AccessImpl>& f );
+	/// Node with edge weights (see AggregateNode)
+	template<typename A>
+	using EdgeAggregateNode = AggregateNode<A, true>;
 	
-	template<typename AccessImpl>
-	class STF {
-	public :
-		explicit STF( size_t n ) : nodes( n ) {}
+	/* Node with a value that keeps the aggregate of the values in its search subtree, including the
+	 * non-separator children. The aggregate at a search tree root covers its component (see
+	 * STF::component_aggregate()). Since the non-separator children are not linked from their
+	 * parent, each node keeps their aggregates in a multiset (see MinAggregate). */
+	template<typename A>
+	struct ComponentAggregateNode : NodeBase<ComponentAggregateNode<A>> {
+		typedef A Aggregate;
+		typedef typename A::Value Value;
 		
-		inline Node* get_node( size_t idx ) { return &nodes[idx]; }
+		static const bool HAS_COMPONENT_AGGREGATE = true;
 		
-		[[nodiscard]] inline size_t num_nodes() const { return nodes.size(); }
+		ComponentAggregateNode* parent;
+		ComponentAggregateNode* dsep_child;
+		ComponentAggregateNode* isep_child;
 		
-		void link( size_t u_idx, size_t v_idx ) {
-			Node* u = get_node( u_idx );
-			Node* v = get_node( v_idx );
-			AccessImpl::access( u );
-			AccessImpl::access( v );
-			u->attach( v );
-		}
+		Value value = Value();
+		Value subtree = Value();
+		typename A::Multiset nonsep_subtrees;
 		
-		void cut( size_t u_idx, size_t v_idx ) {
-			Node* u = get_node( u_idx );
-			Node* v = get_node( v_idx );
-			AccessImpl::access( u );
-			AccessImpl::access( v );
-			u->detach();
+		inline void update_subtree() {
+			Value a = A::combine( value, nonsep_subtrees.get() );
+			if( dsep_child ) {
+				a = A::combine( a, dsep_child->subtree );
+			}
+			if( isep_child ) {
+				a = A::combine( a, isep_child->subtree );
+			}
+			subtree = a;
 		}
 		
-		bool is_connected( size_t u_idx, size_t v_idx ) {
-			Node* u = get_node( u_idx );
-			Node* v = get_node( v_idx );
-			AccessImpl::access( u );
-			AccessImpl::access( v );
-			return u->get_stt_root() == v;
+		inline void prepare_rotation( ComponentAggregateNode* p ) {
+			if( !this->is_separator_hint( p ) ) {
+				p->nonsep_subtrees.erase( subtree );
+			}
 		}
 		
-		friend std::ostream& operator<< <>( std::ostream& os, stt::STF<AccessImpl>& f );
+		inline void move_subtree_data( ComponentAggregateNode* p, ComponentAggregateNode* ) {
+			// Only p and this node may have changed their separator roles
+			p->update_subtree();
+			if( p != dsep_child && p != isep_child ) {
+				nonsep_subtrees.insert( p->subtree );
+			}
+			update_subtree();
+		}
 		
-	private :
-		std::vector<Node> nodes;
-	};
-
-	template<typename AccessImpl>
-	void _write_tree( std::ostream& os, STF<AccessImpl>& f, size_t v_idx, const std::vector<std::vector<size_t>>& node_children, const std::string& indent = "" ) {
-		if( indent.length() >= 1000 ) {
-			std::cerr << "Refusing to write tree of depth >= 1000\n";
-			exit( -1 );
+		inline void add_child_subtree( const ComponentAggregateNode* c ) {
+			nonsep_subtrees.insert( c->subtree );
+			update_subtree();
 		}
-		auto v = f.get_node( v_idx );
-		os << indent << v_idx;
-		// os << "[" << v << "]";
-		if( v->parent && v->parent->dsep_child == v ) { os << "d"; }
-		else if( v->parent && v->parent->isep_child == v ) { os << "i"; }
-		os << "\n";
-		for( const size_t c_idx : node_children[v_idx] ) {
-			_write_tree( os, f, c_idx, node_children, indent + "  " );
+		
+		inline void remove_child_subtree( const ComponentAggregateNode* c ) {
+			nonsep_subtrees.erase( c->subtree );
+			update_subtree();
 		}
-	}
-
-	template<typename AccessImpl>
-	std::ostream& operator<<( std::ostream& os, STF<AccessImpl>& f ) {
-		std::unordered_map<Node*, size_t> node_indices;
-		for( size_t i = 0; i < f.num_nodes(); i++ ) {
-			node_indices[f.get_node( i )] = i;
+		
+		inline void copy_payload( const ComponentAggregateNode* v ) {
+			value = v->value;
 		}
-		std::vector<std::vector<size_t>> node_children( f.num_nodes() );
-		for( size_t i = 0; i < f.num_nodes(); i++ ) {
-			Node* v = f.get_node( i );
-			if( v->parent ) {
-				node_children[node_indices[v->parent]].push_back( i );
-			}
+		
+		inline void clear_derived_payload() {
+			nonsep_subtrees = typename A::Multiset();
 		}
-		for( size_t i = 0; i < f.num_nodes(); i++ ) {
-			if( f.get_node( i )->parent == nullptr ) {
-				_write_tree( os, f, i, node_children );
+		
+		inline void rebuild_payload() {
+			update_subtree();
+			if( parent && !this->is_separator_hint( parent ) ) {
+				parent->nonsep_subtrees.insert( subtree );
 			}
 		}
-		return os;
-	}
-}
+	};
+	
+	/* Node that keeps the number of vertices in its search subtree, including the non-separator
+	 * children. The size of a search tree root is the size of its component (see
+	 * STF::component_size()). Also keeps the number of its separator descendants, i.e., of the
+	 * vertices on the path between its boundary vertices (see STF::distance()). */
+	struct SizeNode : NodeBase<SizeNode> {
+		static const bool HAS_SUBTREE_SIZE = true;
+		static const bool HAS_AGGREGATE = true;
+		
+		SizeNode* parent;
+		SizeNode* dsep_child;
+		SizeNode* isep_child;
+		
+		size_t size = 1;
+		size_t path_size = 1;
+		
+		inline void update_aggregate() {
+			path_size = 1 + ( dsep_child ? dsep_child->path_size : 0 ) + ( isep_child ? isep_child->path_size : 0 );
+		}
+		
+		inline void move_subtree_data( SizeNode* p, SizeNode* c ) {
+			// p loses this node's subtree except for c's
+			const size_t old_size = size;
+			size = p->size;
+			p->size -= old_size - ( c ? c->size : 0 );
+		}
+		
+		inline void add_child_subtree( const SizeNode* c ) {
+			size += c->size;
+		}
+		
+		inline void remove_child_subtree( const SizeNode* c ) {
+			size -= c->size;
+		}
+		
+		inline void clear_derived_payload() {
+			size = 1;
+		}
+		
+		// The size starts at 1, and the children add theirs
+		inline void rebuild_payload() {
+			update_aggregate();
+			if( parent ) {
+				parent->size += size;
+			}
+		}
+	};
+	
+	/* Node that can be marked, and keeps the nearest marked vertex in its search subtree as seen from
+	 * each of its boundary vertices (see STF::nearest_marked()). The nearest marked vertex seen from
+	 * this node in the subtree of a non-separator child is kept in a multiset, as in
+	 * ComponentAggregateNode. Also keeps the number of marked separator descendants and the number
+	 * of all separator descendants (see RootedSTF::nearest_marked_ancestor()). */
+	struct MarkNode : NodeBase<MarkNode> {
+		static const bool HAS_COMPONENT_AGGREGATE = true;
+		static const bool HAS_MARKS = true;
+		
+		/// A marked vertex and its distance, or null (see not_found())
+		struct Nearest {
+			size_t distance;
+			MarkNode* vertex;
+			
+			bool operator<( const Nearest& other ) const {
+				return distance < other.distance || ( distance == other.distance && vertex < other.vertex );
+			}
+			
+			Nearest shifted( size_t d ) const {
+				return vertex ? Nearest{ distance + d, vertex } : *this;
+			}
+		};
+		
+		static inline Nearest not_found() {
+			return Nearest{ size_t( -1 ), nullptr };
+		}
+		
+		MarkNode* parent;
+		MarkNode* dsep_child;
+		MarkNode* isep_child;
+		
+		bool marked = false;
+		size_t path_size = 1;
+		size_t path_marked = 0;
+		
+		// Nearest marked vertex from the parent and the other boundary vertex
+		Nearest from_parent = not_found();
+		Nearest from_other = not_found();
+		
+		// Nearest marked vertex from this node in the subtree of each non-separator child
+		std::multiset<Nearest> nonsep_nearest;
+		
+		/// Nearest marked vertex from this node.
+		inline Nearest nearest() const {
+			return std::min( { own(), nearest_in( dsep_child ), nearest_in( isep_child ), nonsep() } );
+		}
+		
+		inline void update_marks() {
+			const size_t dsep_size = dsep_child ? dsep_child->path_size : 0;
+			const size_t isep_size = isep_child ? isep_child->path_size : 0;
+			path_size = 1 + dsep_size + isep_size;
+			path_marked = marked + ( dsep_child ? dsep_child->path_marked : 0 ) + ( isep_child ? isep_child->path_marked : 0 );
+			
+			// From a boundary vertex, the subtree of the separator child on its side is nearest, and
+			// everything else is reached via this node
+			const Nearest here = std::min( own(), nonsep() );
+			from_parent = std::min( dsep_child ? dsep_child->from_other : not_found(),
+					std::min( here, nearest_in( isep_child ) ).shifted( dsep_size + 1 ) );
+			from_other = std::min( isep_child ? isep_child->from_other : not_found(),
+					std::min( here, nearest_in( dsep_child ) ).shifted( isep_size + 1 ) );
+		}
+		
+		inline void prepare_rotation( MarkNode* p ) {
+			if( !this->is_separator_hint( p ) ) {
+				p->nonsep_nearest.erase( p->nonsep_nearest.find( from_parent ) );
+			}
+		}
+		
+		inline void move_subtree_data( MarkNode* p, MarkNode* c ) {
+			// c's parent changed, which swaps its boundary vertices
+			if( c ) {
+				c->update_marks();
+			}
+			p->update_marks();
+			if( p != dsep_child && p != isep_child ) {
+				nonsep_nearest.insert( p->from_parent );
+			}
+			update_marks();
+		}
+		
+		inline void add_child_subtree( const MarkNode* c ) {
+			nonsep_nearest.insert( c->from_parent );
+			update_marks();
+		}
+		
+		inline void remove_child_subtree( const MarkNode* c ) {
+			nonsep_nearest.erase( nonsep_nearest.find( c->from_parent ) );
+			update_marks();
+		}
+		
+		inline void copy_payload( const MarkNode* v ) {
+			marked = v->marked;
+		}
+		
+		inline void clear_derived_payload() {
+			nonsep_nearest.clear();
+		}
+		
+		// Ties between nearest vertices are broken by address, so this must not be copied
+		inline void rebuild_payload() {
+			update_marks();
+			if( parent && !this->is_separator_hint( parent ) ) {
+				parent->nonsep_nearest.insert( from_parent );
+			}
+		}
+		
+	private :
+		inline Nearest own() const {
+			return marked ? Nearest{ 0, const_cast<MarkNode*>( this ) } : not_found();
+		}
+		
+		inline Nearest nonsep() const {
+			return nonsep_nearest.empty() ? not_found() : *nonsep_nearest.begin();
+		}
+		
+		// Nearest marked vertex in the subtree of the separator child c, seen from this node
+		static inline Nearest nearest_in( const MarkNode* c ) {
+			return c ? c->from_parent : not_found();
+		}
+	};
+	
+	
+	// Rotation policies, used by the access implementations to select one of the rotation kernels
+	
+	/// Rotation with NodeBase::rotate_basic(), which returns nothing
+	struct BasicRotation {
+		template<typename NodeRef>
+		static inline void rotate( NodeRef v ) { v->rotate_basic(); }
+	};
+	
+	/// Rotation with NodeBase::rotate_improved(), which returns whether v is a separator afterwards
+	struct ImprovedRotation {
+		template<typename NodeRef>
+		static inline bool rotate( NodeRef v ) { return v->rotate_improved(); }
+	};
+	
+	/* Rotation with NodeBase::rotate_nst(), which returns the NodeSepType of v afterwards. Also
+	 * provides the kernels for a known NodeSepType of v, and splay steps given the NodeSepTypes of v
+	 * and its parent p. Branchless selects the kernels without data-dependent branches, and
+	 * FusedSplaySteps whether a splay step uses NodeBase::splay_step_fused() or two rotations. */
+	template<bool Branchless, bool FusedSplaySteps>
+	struct BasicNSTRotation {
+		template<typename NodeRef>
+		static inline NodeSepType rotate( NodeRef v ) { return v->template rotate_nst<Branchless>(); }
+		
+		template<typename NodeRef>
+		static inline NodeSepType rotate_dsep( NodeRef v ) { return v->template rotate_dsep<Branchless>(); }
+		
+		template<typename NodeRef>
+		static inline NodeSepType rotate_isep( NodeRef v ) { return v->template rotate_isep<Branchless>(); }
+		
+		template<typename NodeRef>
+		static inline NodeSepType rotate_nosep( NodeRef v ) { return v->template rotate_nosep<Branchless>(); }
+		
+		template<typename NodeRef>
+		static inline NodeSepType rotate_type_hint( NodeRef v, const NodeSepType type ) {
+			return v->template rotate_type_hint<Branchless>( type );
+		}
+		
+		// Rotates twice at v if v is the dsep child of p, and otherwise at p and then at v
+		template<typename NodeRef>
+		static inline void splay_step( NodeRef v, const NodeSepType v_type, NodeRef p, const NodeSepType p_type ) {
+			if( FusedSplaySteps ) {
+				v->template splay_step_fused<Branchless>( v_type, p, p_type );
+			}
+			else if( v_type == DSEP ) {
+				rotate_dsep( v );
+				rotate_type_hint( v, p_type );
+			}
+			else {
+				rotate_type_hint( p, p_type );
+				rotate( v );
+			}
+		}
+	};
+	
+	struct NSTRotation : BasicNSTRotation<false, true> {};
+	
+	/// NSTRotation with kernels that use conditional moves instead of data-dependent branches
+	struct BranchlessRotation : BasicNSTRotation<true, true> {};
+	
+	/// NSTRotation with splay steps as two separate rotations, to compare with the fused kernel
+	struct UnfusedRotation : BasicNSTRotation<false, false> {};
+	
+	/* Access implementation A with the rotation policy R instead of its own. The access
+	 * implementations take the policy as the first template argument of access(), which defaults to
+	 * their own Rotation. */
+	template<typename A, typename R>
+	struct WithRotation {
+		typedef R Rotation;
+		
+		template<typename Rot = Rotation, typename NodeRef>
+		static inline void access( NodeRef v ) {
+			A::template access<Rot>( v );
+		}
+	};
+	
+	/// Counter of CountingRotation, set by the STF before each access it counts.
+	inline size_t*& rotation_counter() {
+		static thread_local size_t* counter = nullptr;
+		return counter;
+	}
+	
+	/* Rotation policy R that also adds the number of rotations to *rotation_counter(). Used by STF
+	 * with STFOptions with LimitDepth to measure the depth of an access (see STF::access()). The
+	 * functions take R as the parameter Q, so that only those that R provides are declared. */
+	template<typename R>
+	struct CountingRotation {
+		template<typename NodeRef, typename Q = R>
+		static inline auto rotate( NodeRef v ) -> decltype( Q::rotate( v ) ) {
+			++*rotation_counter();
+			return Q::rotate( v );
+		}
+		
+		template<typename NodeRef, typename Q = R>
+		static inline auto rotate_dsep( NodeRef v ) -> decltype( Q::rotate_dsep( v ) ) {
+			++*rotation_counter();
+			return Q::rotate_dsep( v );
+		}
+		
+		template<typename NodeRef, typename Q = R>
+		static inline auto rotate_isep( NodeRef v ) -> decltype( Q::rotate_isep( v ) ) {
+			++*rotation_counter();
+			return Q::rotate_isep( v );
+		}
+		
+		template<typename NodeRef, typename Q = R>
+		static inline auto rotate_nosep( NodeRef v ) -> decltype( Q::rotate_nosep( v ) ) {
+			++*rotation_counter();
+			return Q::rotate_nosep( v );
+		}
+		
+		template<typename NodeRef, typename Q = R>
+		static inline auto rotate_type_hint( NodeRef v, const NodeSepType type ) -> decltype( Q::rotate_type_hint( v, type ) ) {
+			++*rotation_counter();
+			return Q::rotate_type_hint( v, type );
+		}
+		
+		template<typename NodeRef, typename Q = R>
+		static inline auto splay_step( NodeRef v, const NodeSepType v_type, NodeRef p, const NodeSepType p_type )
+				-> decltype( Q::splay_step( v, v_type, p, p_type ) ) {
+			*rotation_counter() += 2;
+			return Q::splay_step( v, v_type, p, p_type );
+		}
+	};
+	
+	
+	// Splay-related stuff
+	template<typename Rotation, typename NodeRef>
+	static inline void splay_step( NodeRef v ) {
+		NodeRef p = v->parent;
+		if( p->dsep_child == v ) {
+			Rotation::rotate( v );
+		}
+		else if( p->parent ) {
+			Rotation::rotate( p );
+		}
+		Rotation::rotate( v );
+	}
+	
+	template<typename Rotation, typename NodeRef>
+	static inline void splay_step_full( NodeRef v, NodeRef p ) {
+		if( p->dsep_child == v ) {
+			Rotation::rotate( v );
+		}
+		else {
+			Rotation::rotate( p );
+		}
+		Rotation::rotate( v );
+	}
+	
+	template<typename Rotation, typename NodeRef>
+	static inline void splay_step_type_hint( NodeRef v, const NodeSepType v_type, NodeRef p, const NodeSepType p_type ) {
+		Rotation::splay_step( v, v_type, p, p_type );
+	}
+	
+	template<typename NodeRef>
+	static inline bool can_splay_step( NodeRef v ) {
+		NodeRef p = v->parent;
+		assert( p );
+		NodeRef g = p->parent;
+		return !g || !g->is_separator() || ( v->is_separator_hint( p ) && p->is_separator_hint( g ) );
+	}
+	
+	/* Rotates v up until it is a child of the root, like the MTR access. v must not be the root. The
+	 * root is unchanged. */
+	template<typename NodeRef>
+	static inline void rotate_to_root_child( NodeRef v ) {
+		assert( v->parent );
+		// Separators are never children of the root
+		NodeSepType v_sep_type = v->get_sep_type();
+		while( v_sep_type != NOSEP ) {
+			v_sep_type = v->rotate_type_hint( v_sep_type );
+		}
+		while( v->parent->parent ) {
+			NodeRef p = v->parent;
+			NodeSepType p_sep_type = p->get_sep_type();
+			while( p_sep_type != NOSEP ) {
+				p_sep_type = p->rotate_type_hint( p_sep_type );
+			}
+			v->rotate_nosep();
+		}
+	}
+	
+	/* Asks the CPU to fetch the links of v into the cache, in preparation for a rotation. Does not
+	 * block, and does nothing if v is null. */
+	template<typename NodeRef>
+	static inline void prefetch_node( NodeRef v ) {
+		__builtin_prefetch( v, 1 );
+	}
+	
+	
+	/// Node storage as a contiguous std::vector of nodes.
+	template<typename N>
+	class VectorStorage {
+	public :
+		typedef N* NodeRef;
+		
+		explicit VectorStorage( size_t n ) : nodes( n ) {}
+		
+		inline N* get( size_t idx ) { return &nodes[idx]; }
+		
+		[[nodiscard]] inline size_t index_of( const N* v ) const { return v - nodes.data(); }
+		
+		[[nodiscard]] inline size_t size() const { return nodes.size(); }
+		
+		void swap( VectorStorage& other ) { nodes.swap( other.nodes ); }
+		
+	private :
+		std::vector<N> nodes;
+	};
+	
+	/* Default node storage: a contiguous array of nodes in an Arena, so that the nodes start at a
+	 * cache line boundary and can be backed by huge pages (see default_page_mode()). */
+	template<typename N>
+	class ArenaStorage {
+	public :
+		typedef N* NodeRef;
+		
+		static const size_t ALIGNMENT = 64;
+		
+		explicit ArenaStorage( size_t n ) :
+				arena( n * sizeof( N ), ALIGNMENT ),
+				nodes( reinterpret_cast<N*>( arena.data() ) ),
+				n( n ) {
+			for( size_t i = 0; i < n; i++ ) {
+				new( nodes + i ) N();
+			}
+		}
+		
+		ArenaStorage( const ArenaStorage& ) = delete;
+		
+		~ArenaStorage() {
+			// Only needed for nodes with additional data, like ComponentAggregateNode
+			if( !std::is_trivially_destructible<N>::value ) {
+				for( size_t i = 0; i < n; i++ ) {
+					nodes[i].~N();
+				}
+			}
+		}
+		
+		inline N* get( size_t idx ) { return nodes + idx; }
+		
+		[[nodiscard]] inline size_t index_of( const N* v ) const { return v - nodes; }
+		
+		[[nodiscard]] inline size_t size() const { return n; }
+		
+		void swap( ArenaStorage& other ) {
+			arena.swap( other.arena );
+			std::swap( nodes, other.nodes );
+			std::swap( n, other.n );
+		}
+		
+	private :
+		Arena arena;
+		N* nodes;
+		size_t n;
+	};
+	
+	/* Growable node storage: nodes are stored in chunks of CHUNK_SIZE bytes, which are never moved,
+	 * so NodeRefs stay valid when nodes are added (see STF::add_node()). Each chunk is an Arena
+	 * aligned to its size that starts with the index of its first node, so that index_of() can find
+	 * it from the node address. */
+	template<typename N>
+	class ChunkedStorage {
+	public :
+		typedef N* NodeRef;
+		
+		/// One huge page, so that each chunk can be backed by a single one.
+		static const size_t CHUNK_SIZE = HUGE_PAGE_SIZE;
+		
+		/// Byte offset of the first node in each chunk, after the index of that node.
+		static const size_t FIRST_NODE_OFFSET = 64;
+		
+		static const size_t NODES_PER_CHUNK = ( CHUNK_SIZE - FIRST_NODE_OFFSET ) / sizeof( N );
+		
+		explicit ChunkedStorage( size_t n = 0 ) : n( 0 ) {
+			for( size_t i = 0; i < n; i++ ) {
+				add();
+			}
+		}
+		
+		ChunkedStorage( const ChunkedStorage& ) = delete;
+		
+		~ChunkedStorage() {
+			if( !std::is_trivially_destructible<N>::value ) {
+				for( size_t i = 0; i < n; i++ ) {
+					get( i )->~N();
+				}
+			}
+		}
+		
+		inline N* get( size_t idx ) {
+			return first_node( chunks[idx / NODES_PER_CHUNK]->data() ) + idx % NODES_PER_CHUNK;
+		}
+		
+		[[nodiscard]] inline size_t index_of( const N* v ) const {
+			char* chunk = reinterpret_cast<char*>( reinterpret_cast<uintptr_t>( v ) & ~( uintptr_t( CHUNK_SIZE ) - 1 ) );
+			return *reinterpret_cast<const size_t*>( chunk ) + ( v - first_node( chunk ) );
+		}
+		
+		[[nodiscard]] inline size_t size() const { return n; }
+		
+		/// Adds a default-constructed node and returns its index.
+		size_t add() {
+			if( n % NODES_PER_CHUNK == 0 ) {
+				chunks.emplace_back( new Arena( CHUNK_SIZE, CHUNK_SIZE ) );
+				*reinterpret_cast<size_t*>( chunks.back()->data() ) = n;
+			}
+			new( get( n ) ) N();
+			return n++;
+		}
+		
+		/// Replaces the node at idx by a default-constructed one.
+		void reset( size_t idx ) {
+			N* v = get( idx );
+			v->~N();
+			new( v ) N();
+		}
+		
+		void swap( ChunkedStorage& other ) {
+			chunks.swap( other.chunks );
+			std::swap( n, other.n );
+		}
+		
+	private :
+		static inline N* first_node( char* chunk ) {
+			return reinterpret_cast<N*>( chunk + FIRST_NODE_OFFSET );
+		}
+		
+		std::vector<std::unique_ptr<Arena>> chunks;
+		size_t n;
+	};
+	
+	/// Whether nodes can be added to storage S without moving the others (see STF::add_node()).
+	template<typename S>
+	struct is_growable_storage : std::false_type {};
+	
+	template<typename N>
+	struct is_growable_storage<ChunkedStorage<N>> : std::true_type {};
+	
+	
+	
+	// Compact node representations
+	
+	static_assert( sizeof( uintptr_t ) == 8, "Compact nodes require 64-bit addresses" );
+	
+	/// Compact nodes live in an arena of this size, aligned to its size.
+	static const uintptr_t COMPACT_ARENA_SIZE = uintptr_t( 1 ) << 32;
+	
+	/* Links between compactly stored nodes are stored as the lower 32 bits of the target address.
+	 * Since the arena is aligned to its size, the upper bits are the same as those of the address
+	 * where the link itself is stored. The value 0 represents null (the arena never places a node at
+	 * its start). */
+	static inline uint32_t compress_link( const void* at, const void* target ) {
+		assert( target == nullptr || ( reinterpret_cast<uintptr_t>( target ) ^ reinterpret_cast<uintptr_t>( at ) ) < COMPACT_ARENA_SIZE );
+		(void) at;
+		return static_cast<uint32_t>( reinterpret_cast<uintptr_t>( target ) );
+	}
+	
+	template<typename T>
+	static inline T* expand_link( const void* at, uint32_t link ) {
+		uintptr_t base = reinterpret_cast<uintptr_t>( at ) & ~( COMPACT_ARENA_SIZE - 1 );
+		return link ? reinterpret_cast<T*>( base | link ) : nullptr;
+	}
+	
+	/* Link member of a CompactNode. If Tagged is true, the lowest bits hold a NodeSepType (nodes are
+	 * 4-byte aligned, so these bits are always zero in the compressed address). */
+	template<typename N, bool Tagged = false>
+	class CompactLink {
+	public :
+		static const uint32_t TAG_MASK = Tagged ? ( uint32_t( 1 ) << SEP_TYPE_TAG_BITS ) - 1 : 0;
+		
+		inline operator N*() const { return expand_link<N>( this, offset & ~TAG_MASK ); }
+		
+		inline N* operator->() const { return *this; }
+		
+		/// Changes the target, keeping the tag.
+		inline CompactLink& operator=( N* v ) {
+			offset = compress_link( this, v ) | ( offset & TAG_MASK );
+			return *this;
+		}
+		
+		[[nodiscard]] inline NodeSepType tag() const { return NodeSepType( offset & TAG_MASK ); }
+		
+		inline void set_tag( NodeSepType t ) { offset = ( offset & ~TAG_MASK ) | t; }
+		
+	private :
+		uint32_t offset;
+	};
+	
+	/// Node with 32-bit links, taking 12 instead of 24 bytes. Must be stored in a CompactStorage.
+	struct CompactNode : NodeBase<CompactNode> {
+		CompactLink<CompactNode> parent;
+		CompactLink<CompactNode> dsep_child;
+		CompactLink<CompactNode> isep_child;
+	};
+	
+	static_assert( sizeof( CompactNode ) == 12, "Unexpected padding in CompactNode" );
+	
+	/// CompactNode that stores its own NodeSepType in the parent link, see TaggedNode.
+	struct TaggedCompactNode : NodeBase<TaggedCompactNode> {
+		static const bool STORES_SEP_TYPE = true;
+		
+		CompactLink<TaggedCompactNode, true> parent;
+		CompactLink<TaggedCompactNode> dsep_child;
+		CompactLink<TaggedCompactNode> isep_child;
+		
+		[[nodiscard]] inline NodeSepType stored_sep_type() const { return parent.tag(); }
+		
+		inline void set_sep_type( NodeSepType t ) { parent.set_tag( t ); }
+	};
+	
+	static_assert( sizeof( TaggedCompactNode ) == 12, "Unexpected padding in TaggedCompactNode" );
+	
+	/// Stores compact nodes of type N in a 4 GiB-aligned arena, as required by CompactLink.
+	template<typename N>
+	class BasicCompactStorage {
+	public :
+		typedef N* NodeRef;
+		
+		/// Byte offset of the first node in the arena. Must be positive, since offset 0 means null.
+		static const size_t FIRST_NODE_OFFSET = 64;
+		
+		static const size_t MAX_NODES = ( COMPACT_ARENA_SIZE - FIRST_NODE_OFFSET ) / sizeof( N );
+		
+		explicit BasicCompactStorage( size_t n ) :
+				arena( FIRST_NODE_OFFSET + checked_size( n ) * sizeof( N ), COMPACT_ARENA_SIZE ),
+				nodes( reinterpret_cast<N*>( arena.data() + FIRST_NODE_OFFSET ) ),
+				n( n ) {
+			for( size_t i = 0; i < n; i++ ) {
+				new( nodes + i ) N();
+			}
+		}
+		
+		inline N* get( size_t idx ) { return nodes + idx; }
+		
+		[[nodiscard]] inline size_t index_of( const N* v ) const { return v - nodes; }
+		
+		[[nodiscard]] inline size_t size() const { return n; }
+		
+		void swap( BasicCompactStorage& other ) {
+			arena.swap( other.arena );
+			std::swap( nodes, other.nodes );
+			std::swap( n, other.n );
+		}
+		
+	private :
+		static size_t checked_size( size_t n ) {
+			if( n > MAX_NODES ) {
+				throw std::length_error( "Too many nodes for CompactStorage" );
+			}
+			return n;
+		}
+		
+		Arena arena;
+		N* nodes;
+		size_t n;
+	};
+	
+	typedef BasicCompactStorage<CompactNode> CompactStorage;
+	
+	
+	/* Structure-of-arrays representation: The arena is split into three regions, containing the
+	 * parent, dsep_child and isep_child links of all nodes, respectively. Links are compressed as for
+	 * CompactNode. A node is identified by the address of its parent link; its other links are at a
+	 * fixed distance from that address. The distance is not a multiple of the page size, so that the
+	 * three links of a node do not compete for the same cache set. */
+	static const uintptr_t SOA_REGION_STRIDE = ( uintptr_t( 1 ) << 30 ) + 192;
+	
+	class SoANode;
+	
+	/// Handle of a node in a SoAStorage.
+	class SoANodeRef {
+	public :
+		SoANodeRef( std::nullptr_t = nullptr ) : slot( nullptr ) {}
+		
+		explicit SoANodeRef( uint32_t* parent_slot ) : slot( parent_slot ) {}
+		
+		inline SoANode operator->() const;
+		
+		explicit operator bool() const { return slot != nullptr; }
+		
+		/// Address of the node's parent link
+		[[nodiscard]] inline uint32_t* parent_slot() const { return slot; }
+		
+		/// Address of the node's dsep_child (k = 1) or isep_child (k = 2) link
+		[[nodiscard]] inline uint32_t* slot_at( int k ) const {
+			return reinterpret_cast<uint32_t*>( reinterpret_cast<char*>( slot ) + k * SOA_REGION_STRIDE );
+		}
+		
+	private :
+		uint32_t* slot;
+	};
+	
+	inline bool operator==( SoANodeRef u, SoANodeRef v ) { return u.parent_slot() == v.parent_slot(); }
+	
+	inline bool operator!=( SoANodeRef u, SoANodeRef v ) { return u.parent_slot() != v.parent_slot(); }
+	
+	/// Reference to one link of a SoA node.
+	class SoALink {
+	public :
+		explicit SoALink( uint32_t* slot ) : slot( slot ) {}
+		
+		inline operator SoANodeRef() const { return SoANodeRef( expand_link<uint32_t>( slot, *slot ) ); }
+		
+		inline SoANode operator->() const;
+		
+		explicit operator bool() const { return *slot != 0; }
+		
+		inline SoALink& operator=( SoANodeRef v ) {
+			*slot = compress_link( slot, v.parent_slot() );
+			return *this;
+		}
+		
+		/// Assigns the target of the other link (not the slot).
+		inline SoALink& operator=( const SoALink& other ) {
+			*slot = *other.slot;
+			return *this;
+		}
+		
+	private :
+		uint32_t* slot;
+	};
+	
+	/// Temporary view of a node in a SoAStorage, as returned by SoANodeRef::operator->().
+	class SoANode : public NodeBase<SoANode, SoANodeRef> {
+	public :
+		explicit SoANode( SoANodeRef v ) :
+				parent( v.parent_slot() ), dsep_child( v.slot_at( 1 ) ), isep_child( v.slot_at( 2 ) ), v( v ) {}
+		
+		inline SoANode* operator->() { return this; }
+		
+		inline SoANodeRef ref() const { return v; }
+		
+		SoALink parent;
+		SoALink dsep_child;
+		SoALink isep_child;
+		
+	private :
+		SoANodeRef v;
+	};
+	
+	inline SoANode SoANodeRef::operator->() const { return SoANode( *this ); }
+	
+	inline SoANode SoALink::operator->() const { return SoANode( *this ); }
+	
+	/// Node type behind a NodeRef, to read its flags (only used in unevaluated contexts).
+	template<typename N>
+	N node_type_of( N* );
+	SoANode node_type_of( SoANodeRef );
+	
+	template<>
+	inline void prefetch_node( SoANodeRef v ) {
+		if( v ) {
+			__builtin_prefetch( v.parent_slot(), 1 );
+			__builtin_prefetch( v.slot_at( 1 ), 1 );
+			__builtin_prefetch( v.slot_at( 2 ), 1 );
+		}
+	}
+	
+	/// Stores nodes as a structure of arrays. See SOA_REGION_STRIDE.
+	class SoAStorage {
+	public :
+		typedef SoANodeRef NodeRef;
+		
+		/// Byte offset of the first link in each region. Must be positive, since offset 0 means null.
+		static const size_t FIRST_NODE_OFFSET = 64;
+		
+		static const size_t MAX_NODES = ( SOA_REGION_STRIDE - FIRST_NODE_OFFSET ) / sizeof( uint32_t );
+		
+		explicit SoAStorage( size_t n ) :
+				arena( 2 * SOA_REGION_STRIDE + FIRST_NODE_OFFSET + checked_size( n ) * sizeof( uint32_t ), COMPACT_ARENA_SIZE ),
+				parents( reinterpret_cast<uint32_t*>( arena.data() + FIRST_NODE_OFFSET ) ),
+				n( n ) {}
+		
+		inline SoANodeRef get( size_t idx ) { return SoANodeRef( parents + idx ); }
+		
+		[[nodiscard]] inline size_t index_of( SoANodeRef v ) const { return v.parent_slot() - parents; }
+		
+		[[nodiscard]] inline size_t size() const { return n; }
+		
+		void swap( SoAStorage& other ) {
+			arena.swap( other.arena );
+			std::swap( parents, other.parents );
+			std::swap( n, other.n );
+		}
+		
+	private :
+		static size_t checked_size( size_t n ) {
+			if( n > MAX_NODES ) {
+				throw std::length_error( "Too many nodes for SoAStorage" );
+			}
+			return n;
+		}
+		
+		Arena arena; // Zero-initialized, so all links are null initially
+		uint32_t* parents;
+		size_t n;
+	};
+	
+	
+	
+	// Node storage used by STF unless specified otherwise
+#if defined( COMPACT_NODES ) && defined( SEP_TYPE_TAGS )
+	typedef BasicCompactStorage<TaggedCompactNode> DefaultStorage;
+#elif defined( COMPACT_NODES )
+	typedef CompactStorage DefaultStorage;
+#elif defined( SOA_NODES ) && defined( SEP_TYPE_TAGS )
+#error "SEP_TYPE_TAGS is not supported with SOA_NODES"
+#elif defined( SOA_NODES )
+	typedef SoAStorage DefaultStorage;
+#elif defined( CHUNKED_NODES ) && defined( SEP_TYPE_TAGS )
+	typedef ChunkedStorage<TaggedNode> DefaultStorage;
+#elif defined( CHUNKED_NODES )
+	typedef ChunkedStorage<Node> DefaultStorage;
+#elif defined( SEP_TYPE_TAGS )
+	typedef ArenaStorage<TaggedNode> DefaultStorage;
+#else
+	typedef ArenaStorage<Node> DefaultStorage;
+#endif
+	
+	/// Number of operations after which an STF calls relayout() (0 means never), unless set otherwise.
+	inline size_t& default_relayout_interval() {
+		static size_t interval = 0;
+		return interval;
+	}
+	
+	/// Factor of the depth limit of an STF (0 means no limit, see STF::limit_depth()), unless set otherwise.
+	inline double& default_rebuild_depth() {
+		static double factor = 0;
+		return factor;
+	}
+	
+	/* Handles the command line options of the STT executables (see main_connectivity()):
+	 * --pages=<small|thp|hugetlb> selects the pages backing the node storage.
+	 * --relayout-every=<N> calls STF::relayout() every N operations.
+	 * --rebuild-depth=<F> rebuilds search trees in which an operation starts at depth > F log n.
+	 * The last two need an STF with MaintainedOptions (see named_stt_impl()). */
+	static inline bool handle_option( const std::string& option ) {
+		const std::string pages_prefix = "--pages=";
+		const std::string relayout_prefix = "--relayout-every=";
+		const std::string rebuild_prefix = "--rebuild-depth=";
+		if( option.compare( 0, pages_prefix.size(), pages_prefix ) == 0 ) {
+			const std::string mode = option.substr( pages_prefix.size() );
+			if( mode == "small" ) { default_page_mode() = SMALL_PAGES; }
+			else if( mode == "thp" ) { default_page_mode() = TRANSPARENT_HUGE_PAGES; }
+			else if( mode == "hugetlb" ) { default_page_mode() = HUGETLB_PAGES; }
+			else { return false; }
+			return true;
+		}
+		else if( option.compare( 0, relayout_prefix.size(), relayout_prefix ) == 0 ) {
+			const std::string interval = option.substr( relayout_prefix.size() );
+			if( interval.empty() || interval.find_first_not_of( "0123456789" ) != std::string::npos ) {
+				return false;
+			}
+			default_relayout_interval() = std::stoul( interval );
+			return true;
+		}
+		else if( option.compare( 0, rebuild_prefix.size(), rebuild_prefix ) == 0 ) {
+			const std::string factor = option.substr( rebuild_prefix.size() );
+			char* end;
+			const double f = std::strtod( factor.c_str(), &end );
+			if( factor.empty() || *end != '\0' || !( f >= 0 ) ) {
+				return false;
+			}
+			default_rebuild_depth() = f;
+			return true;
+		}
+		return false;
+	}
+	
+	
+	
+	/* Features of an STF that cost time in every operation, and are therefore only compiled in if
+	 * enabled. Without any of them, link(), cut() and is_connected() only do the two accesses.
+	 * KeepEdges: keep the edges in adjacency lists, which rebuild() and clone_component() need to
+	 * find the vertices of a component in time linear in its size.
+	 * Relayout: translate node indices to storage slots, which relayout() needs to move nodes.
+	 * LimitDepth: count the rotations of each access, and rebuild search trees in which an access
+	 * was too deep (see STF::limit_depth()). Keeps the edges as well. */
+	template<bool KeepEdges = false, bool Relayout = false, bool LimitDepth = false>
+	struct STFOptions {
+		static const bool KEEP_EDGES = KeepEdges || LimitDepth;
+		static const bool RELAYOUT = Relayout;
+		static const bool LIMIT_DEPTH = LimitDepth;
+	};
+	
+	/// All features, for the options --relayout-every and --rebuild-depth (see handle_option()).
+	typedef STFOptions<true, true, true> MaintainedOptions;
+	
+	// Forward declarations
+	template<typename AccessImpl, typename Storage, typename Options>
+	class STF;
+	template<typename AccessImpl, typename Storage, typename Options>
+	std::ostream& operator<<( std::ostream& os, STF<AccessImpl, Storage, Options>& f );
+	
+	/* Dynamic forest based on a search tree on trees. The node representation can be chosen via
+	 * Storage, e.g., ArenaStorage<Node>, CompactStorage or SoAStorage, and optional features via
+	 * Options (see STFOptions). */
+	template<typename AccessImpl, typename Storage = DefaultStorage, typename Options = STFOptions<>>
+	class STF {
+	public :
+		typedef typename Storage::NodeRef NodeRef;
+		// Node type for pointer NodeRefs
+		typedef typename std::remove_pointer<NodeRef>::type Node;
+		
+		/// Returned by distance() if there is no path.
+		static const size_t NONE = size_t( -1 );
+		
+		explicit STF( size_t n ) :
+				nodes( n ),
+				relayout_interval( Options::RELAYOUT ? default_relayout_interval() : 0 ),
+				ops_until_relayout( relayout_interval ),
+				rebuild_depth( Options::LIMIT_DEPTH ? default_rebuild_depth() : 0 ),
+				deep_idx( NONE ),
+				rotations( 0 ) {
+			if( Options::KEEP_EDGES ) {
+				neighbors.resize( n );
+			}
+			if( COUNTS_DEGREES ) {
+				degree.resize( n );
+			}
+			update_max_depth();
+		}
+		
+		inline NodeRef get_node( size_t idx ) {
+			return nodes.get( slot_of( idx ) );
+		}
+		
+		[[nodiscard]] inline size_t get_index( NodeRef v ) const {
+			const size_t slot = nodes.index_of( v );
+			return !Options::RELAYOUT || index_of_slot.empty() ? slot : index_of_slot[slot];
+		}
+		
+		/// Number of node indices, including those of removed nodes.
+		[[nodiscard]] inline size_t num_nodes() const { return nodes.size(); }
+		
+		/* Adds an isolated node and returns its index, reusing the index of a removed node if there
+		 * is one. Other nodes are not moved. Requires a storage that can grow, like ChunkedStorage. */
+		size_t add_node() {
+			static_assert( is_growable_storage<Storage>::value, "add_node() requires ChunkedStorage" );
+			if( !free_indices.empty() ) {
+				const size_t idx = free_indices.back();
+				free_indices.pop_back();
+				removed[idx] = false;
+				nodes.reset( slot_of( idx ) );
+				return idx;
+			}
+			const size_t idx = nodes.add();
+			if( !slot_of_index.empty() ) {
+				slot_of_index.push_back( idx );
+				index_of_slot.push_back( idx );
+			}
+			if( Options::KEEP_EDGES ) {
+				neighbors.emplace_back();
+			}
+			if( COUNTS_DEGREES ) {
+				degree.push_back( 0 );
+			}
+			update_max_depth();
+			return idx;
+		}
+		
+		/* Removes v, which must be isolated and not removed already (otherwise throws
+		 * std::invalid_argument). Its index may be returned by a later call of add_node(). Requires
+		 * ChunkedStorage, like add_node(). */
+		void remove_node( size_t v_idx ) {
+			static_assert( is_growable_storage<Storage>::value, "remove_node() requires ChunkedStorage" );
+			if( removed.size() < nodes.size() ) {
+				removed.resize( nodes.size(), false );
+			}
+			if( removed[v_idx] ) {
+				throw std::invalid_argument( "remove_node(): node already removed" );
+			}
+			if( !is_isolated( v_idx ) ) {
+				throw std::invalid_argument( "remove_node(): node has edges" );
+			}
+			removed[v_idx] = true;
+			free_indices.push_back( v_idx );
+		}
+		
+		/* Moves the nodes in storage such that each search tree is stored in DFS order, so that nodes
+		 * close to each other in a search tree tend to share cache lines and pages. Node indices stay
+		 * valid, but NodeRefs do not. Requires STFOptions with Relayout. */
+		void relayout() {
+			static_assert( Options::RELAYOUT, "relayout() requires STFOptions with Relayout" );
+			relayout_nodes();
+		}
+		
+		/* Adds the given edges, which must form a forest, if all nodes are isolated. Instead of linking
+		 * the edges one by one, this builds search trees of depth at most about 2 log n directly, in
+		 * linear time: Each tree is split into heavy paths (towards the largest child). The search
+		 * tree of a segment of a heavy path, together with the subtrees hanging off it, has the vertex
+		 * of the segment that splits its vertices in half as its root. The segments before and after
+		 * that vertex and the subtrees of its other children become its children. Throws
+		 * std::invalid_argument, without changing the forest, if the edges contain a cycle (or a
+		 * duplicate edge) or a node already has edges. */
+		void build( const std::vector<std::pair<size_t, size_t>>& edges ) {
+			check_build_edges( edges );
+			build_search_trees( nodes.size(), edges, [this]( size_t v ) { return get_node( v ); }, []( size_t ) { return size_t( 1 ); }, []( const std::vector<NodeRef>& ) {} );
+			for( const auto& e : edges ) {
+				add_edge( e.first, e.second );
+			}
+		}
+		
+		/* Rebuilds the search tree of v's component such that vertices with a large access weight
+		 * (given for all nodes) are close to the root, as in build() with weighted vertices. Half of
+		 * the total weight is spread evenly over the component, so a vertex with a fraction p of the
+		 * access weight has depth O(log min(1/p, n)). Takes time linear in the size of the component.
+		 * Requires STFOptions with KeepEdges. */
+		void rebuild( size_t v_idx, const std::vector<double>& access_weights ) {
+			static_assert( Options::KEEP_EDGES, "rebuild() requires STFOptions with KeepEdges" );
+			double total = 0;
+			rebuild_search_tree( v_idx, [&]( const std::vector<NodeRef>& tree ) {
+				for( NodeRef x : tree ) {
+					total += access_weights[get_index( x )];
+				}
+			}, [&]( NodeRef x, size_t k ) {
+				return ( total > 0 ? access_weights[get_index( x )] / total : 0.0 ) + 1.0 / double( k );
+			} );
+		}
+		
+		/* Returns a copy of this forest with the same node indices, e.g. to try out changes on it.
+		 * Takes linear time: Nodes without multisets are copied as they are, in one pass that
+		 * translates their links to the new storage. Other nodes recompute their derived data, as in
+		 * relayout(). */
+		std::unique_ptr<STF> clone() {
+			std::unique_ptr<STF> copy( new STF( nodes.size() ) );
+			clone_into( *copy );
+			return copy;
+		}
+		
+		/* Returns a forest with a copy of the component of v only, where vertex i is the copy of
+		 * vertices[i] (which is filled in). Takes time linear in the size of the component. Requires
+		 * STFOptions with KeepEdges. */
+		std::unique_ptr<STF> clone_component( size_t v_idx, std::vector<size_t>& vertices ) {
+			return clone_component( v_idx, vertices, []( size_t k ) { return std::unique_ptr<STF>( new STF( k ) ); }, []( STF& f ) -> STF& { return f; } );
+		}
+		
+		void link( size_t u_idx, size_t v_idx ) {
+			count_operation();
+			NodeRef u = get_node( u_idx );
+			NodeRef v = get_node( v_idx );
+			access( u );
+			access( v );
+			u->attach( v );
+			add_edge( u_idx, v_idx );
+		}
+		
+		void cut( size_t u_idx, size_t v_idx ) {
+			count_operation();
+			NodeRef u = get_node( u_idx );
+			NodeRef v = get_node( v_idx );
+			access( u );
+			access( v );
+			u->detach();
+			remove_edge( u_idx, v_idx );
+		}
+		
+		bool is_connected( size_t u_idx, size_t v_idx ) {
+			count_operation();
+			NodeRef u = get_node( u_idx );
+			NodeRef v = get_node( v_idx );
+			access( u );
+			access( v );
+			return u->get_stt_root() == v;
+		}
+		
+		/* Sets the weight of v. Requires nodes with aggregates (see AggregateNode), as do the
+		 * following methods. */
+		template<typename N = Node>
+		void set_weight( size_t v_idx, typename N::Value w ) {
+			static_assert( !N::HAS_EDGE_WEIGHTS, "Use link() with a weight to set edge weights" );
+			count_operation();
+			NodeRef v = get_node( v_idx );
+			access( v );
+			v->weight = w;
+			v->update_aggregate(); // v has no separator children as the root
+		}
+		
+		template<typename N = Node>
+		[[nodiscard]] typename N::Value get_weight( size_t v_idx ) {
+			NodeRef v = get_node( v_idx );
+			if( N::HAS_LAZY_UPDATES ) {
+				// Pending additions of the ancestors of v may not be applied yet
+				count_operation();
+				access( v );
+			}
+			return v->weight;
+		}
+		
+		/* Aggregate of the weights of all vertices on the path between u and v, or the identity of
+		 * the aggregate if they are not connected. */
+		template<typename N = Node>
+		typename N::Value path_aggregate( size_t u_idx, size_t v_idx ) {
+			static_assert( !N::HAS_EDGE_WEIGHTS, "Use path_edge_aggregate() for edge weights" );
+			typedef typename N::Aggregate A;
+			count_operation();
+			NodeRef u = get_node( u_idx );
+			NodeRef v = get_node( v_idx );
+			if( u == v ) {
+				return u->weight;
+			}
+			if( !expose_path( u, v ) ) {
+				return A::identity();
+			}
+			typename N::Value result = A::combine( u->weight, v->weight );
+			if( NodeRef d = v->dsep_child ) {
+				result = A::combine( result, d->aggregate );
+			}
+			return result;
+		}
+		
+		/* Links u and v by an edge with weight w. Requires nodes with edge weights (see
+		 * EdgeAggregateNode), as do the following methods. */
+		template<typename N = Node>
+		void link( size_t u_idx, size_t v_idx, typename N::Value w ) {
+			static_assert( N::HAS_EDGE_WEIGHTS, "Edge weights require EdgeAggregateNode" );
+			count_operation();
+			NodeRef u = get_node( u_idx );
+			NodeRef v = get_node( v_idx );
+			access( u );
+			access( v );
+			u->attach( v );
+			add_edge( u_idx, v_idx );
+			// The edge connects u's subtree (just u) to its parent v
+			u->weight = w;
+			u->update_aggregate();
+		}
+		
+		/// Weight of the edge between u and v. Throws std::invalid_argument if they are not adjacent.
+		template<typename N = Node>
+		typename N::Value edge_weight( size_t u_idx, size_t v_idx ) {
+			static_assert( N::HAS_EDGE_WEIGHTS, "Edge weights require EdgeAggregateNode" );
+			count_operation();
+			NodeRef u = get_node( u_idx );
+			NodeRef v = get_node( v_idx );
+			access( u );
+			access( v );
+			// Then u is a child of v exactly if they are adjacent, and its subtree is just u
+			if( u->parent != v || u->dsep_child ) {
+				throw std::invalid_argument( "edge_weight(): vertices are not adjacent" );
+			}
+			return u->weight;
+		}
+		
+		/* Aggregate of the weights of all edges on the path between u and v, or the identity of the
+		 * aggregate if u == v or they are not connected. */
+		template<typename N = Node>
+		typename N::Value path_edge_aggregate( size_t u_idx, size_t v_idx ) {
+			static_assert( N::HAS_EDGE_WEIGHTS, "Edge weights require EdgeAggregateNode" );
+			typedef typename N::Aggregate A;
+			count_operation();
+			NodeRef u = get_node( u_idx );
+			NodeRef v = get_node( v_idx );
+			if( u == v || !expose_path( u, v ) ) {
+				return A::identity();
+			}
+			// The path consists of the edge between v's subtree and u, and, if v is not adjacent to u,
+			// the path between v and u in the subtree of v's dsep child d. The aggregate of d covers
+			// the latter, except for the last edge, which is the former.
+			typename N::Value result = v->weight;
+			if( NodeRef d = v->dsep_child ) {
+				result = A::combine( result, d->aggregate );
+			}
+			return result;
+		}
+		
+		/// Maximum edge weight on the path between u and v (see path_edge_aggregate()).
+		template<typename N = Node>
+		typename N::Value path_max_edge( size_t u_idx, size_t v_idx ) {
+			static_assert( std::is_same<typename N::Aggregate, MaxAggregate<typename N::Value>>::value,
+					"path_max_edge() requires EdgeAggregateNode<MaxAggregate<...>>" );
+			return path_edge_aggregate<N>( u_idx, v_idx );
+		}
+		
+		/// Number of vertices in the tree containing v. Requires SizeNode.
+		template<typename N = Node>
+		size_t component_size( size_t v_idx ) {
+			static_assert( N::HAS_SUBTREE_SIZE, "component_size() requires SizeNode" );
+			count_operation();
+			NodeRef v = get_node( v_idx );
+			access( v );
+			return v->size;
+		}
+		
+		/// Number of edges on the path between u and v, or NONE if they are not connected. Requires SizeNode.
+		template<typename N = Node>
+		size_t distance( size_t u_idx, size_t v_idx ) {
+			static_assert( N::HAS_SUBTREE_SIZE, "distance() requires SizeNode" );
+			count_operation();
+			NodeRef u = get_node( u_idx );
+			NodeRef v = get_node( v_idx );
+			if( u == v ) {
+				return 0;
+			}
+			if( !expose_path( u, v ) ) {
+				return NONE;
+			}
+			NodeRef d = v->dsep_child;
+			return d ? d->path_size + 1 : 1;
+		}
+		
+		/* Returns the vertex on the path from u to v with distance k from u, or NONE if there is no
+		 * such vertex. Requires SizeNode. */
+		template<typename N = Node>
+		size_t kth_on_path( size_t u_idx, size_t v_idx, size_t k ) {
+			static_assert( N::HAS_SUBTREE_SIZE, "kth_on_path() requires SizeNode" );
+			count_operation();
+			NodeRef u = get_node( u_idx );
+			NodeRef v = get_node( v_idx );
+			if( u == v ) {
+				return k == 0 ? u_idx : NONE;
+			}
+			if( !expose_path( u, v ) ) {
+				return NONE;
+			}
+			NodeRef x = kth_on_exposed_path( u, v, k );
+			if( !x ) {
+				return NONE;
+			}
+			access( x ); // Pay for the search
+			return get_index( x );
+		}
+		
+		/// Marks or unmarks v. Requires MarkNode, as does nearest_marked().
+		template<typename N = Node>
+		void set_marked( size_t v_idx, bool marked ) {
+			static_assert( N::HAS_MARKS, "set_marked() requires MarkNode" );
+			count_operation();
+			NodeRef v = get_node( v_idx );
+			access( v );
+			v->marked = marked;
+			v->update_marks(); // v is the root, so no other node depends on its mark
+		}
+		
+		template<typename N = Node>
+		void mark( size_t v_idx ) { set_marked<N>( v_idx, true ); }
+		
+		template<typename N = Node>
+		void unmark( size_t v_idx ) { set_marked<N>( v_idx, false ); }
+		
+		/* Returns a marked vertex with the smallest distance to v in v's tree, or NONE if there is
+		 * none. If distance is not null, stores the distance there. */
+		template<typename N = Node>
+		size_t nearest_marked( size_t v_idx, size_t* distance = nullptr ) {
+			static_assert( N::HAS_MARKS, "nearest_marked() requires MarkNode" );
+			count_operation();
+			NodeRef v = get_node( v_idx );
+			access( v );
+			// As the root, v sees its whole tree
+			const typename N::Nearest nearest = v->nearest();
+			if( distance ) {
+				*distance = nearest.distance;
+			}
+			return nearest.vertex ? get_index( nearest.vertex ) : NONE;
+		}
+		
+		/// Sets the value of v. Requires ComponentAggregateNode, as does component_aggregate().
+		template<typename N = Node>
+		void set_value( size_t v_idx, typename N::Value x ) {
+			static_assert( N::HAS_COMPONENT_AGGREGATE, "set_value() requires ComponentAggregateNode" );
+			count_operation();
+			NodeRef v = get_node( v_idx );
+			access( v );
+			v->value = x;
+			v->update_subtree(); // v is the root, so no other aggregate contains its value
+		}
+		
+		/// Aggregate of the values of all vertices in the tree containing v.
+		template<typename N = Node>
+		typename N::Value component_aggregate( size_t v_idx ) {
+			static_assert( N::HAS_COMPONENT_AGGREGATE, "component_aggregate() requires ComponentAggregateNode" );
+			count_operation();
+			NodeRef v = get_node( v_idx );
+			access( v );
+			return v->subtree;
+		}
+		
+		/* Adds delta to the weights of all vertices on the path between u and v, if they are
+		 * connected. Requires AddNode, as do path_sum() and path_min(). */
+		template<typename N = Node>
+		void path_add( size_t u_idx, size_t v_idx, typename N::Value delta ) {
+			static_assert( N::HAS_LAZY_UPDATES, "path_add() requires AddNode" );
+			count_operation();
+			NodeRef u = get_node( u_idx );
+			NodeRef v = get_node( v_idx );
+			if( u == v ) {
+				access( u );
+				u->add( delta );
+			}
+			else if( expose_path( u, v ) ) {
+				// v is not a separator, so its separator descendants are v and the inner vertices of the path
+				u->add( delta );
+				v->add( delta );
+			}
+		}
+		
+		/// Sum of the weights on the path between u and v, or 0 if they are not connected.
+		template<typename N = Node>
+		typename N::Value path_sum( size_t u_idx, size_t v_idx ) {
+			static_assert( N::HAS_LAZY_UPDATES, "path_sum() requires AddNode" );
+			count_operation();
+			NodeRef u = get_node( u_idx );
+			NodeRef v = get_node( v_idx );
+			if( u == v ) {
+				access( u );
+				return u->weight;
+			}
+			if( !expose_path( u, v ) ) {
+				return typename N::Value();
+			}
+			return u->weight + v->sum;
+		}
+		
+		/// Minimum weight on the path between u and v, or the maximum value if they are not connected.
+		template<typename N = Node>
+		typename N::Value path_min( size_t u_idx, size_t v_idx ) {
+			static_assert( N::HAS_LAZY_UPDATES, "path_min() requires AddNode" );
+			count_operation();
+			NodeRef u = get_node( u_idx );
+			NodeRef v = get_node( v_idx );
+			if( u == v ) {
+				access( u );
+				return u->weight;
+			}
+			if( !expose_path( u, v ) ) {
+				return std::numeric_limits<typename N::Value>::max();
+			}
+			return v->min < u->weight ? v->min : u->weight;
+		}
+		
+		friend std::ostream& operator<< <>( std::ostream& os, stt::STF<AccessImpl, Storage, Options>& f );
+		
+	protected :
+		/* Triggers relayout() every relayout_interval operations, if set, after limiting the depth
+		 * of the previous operation (see limit_depth()). Does nothing without these options. */
+		inline void count_operation() {
+			if( Options::LIMIT_DEPTH ) {
+				limit_depth();
+			}
+			if( Options::RELAYOUT && relayout_interval && --ops_until_relayout == 0 ) {
+				relayout_nodes();
+				ops_until_relayout = relayout_interval;
+			}
+		}
+		
+		// Copies all nodes and settings of this forest to copy, which has as many nodes (see clone()).
+		void clone_into( STF& copy ) {
+			const size_t n = nodes.size();
+			if( !COPY_REBUILDS_PAYLOAD ) {
+				copy_nodes( copy.nodes, n, []( size_t i ) { return i; }, []( size_t slot ) { return slot; } );
+			}
+			else {
+				const std::vector<size_t> order = search_forest_order();
+				copy_nodes( copy.nodes, n, [&]( size_t i ) { return order[i]; }, []( size_t slot ) { return slot; } );
+			}
+			copy.slot_of_index = slot_of_index;
+			copy.index_of_slot = index_of_slot;
+			copy.free_indices = free_indices;
+			copy.removed = removed;
+			copy.neighbors = neighbors;
+			copy.degree = degree;
+			copy.relayout_interval = relayout_interval;
+			copy.ops_until_relayout = ops_until_relayout;
+			copy.rebuild_depth = rebuild_depth;
+			copy.max_depth = max_depth;
+		}
+		
+		/* Copies the component of v to a new forest make( k ) with k nodes, and returns it (see
+		 * clone_component()). base_of( f ) returns the STF of the new forest f. */
+		template<typename Make, typename BaseOf>
+		auto clone_component( size_t v_idx, std::vector<size_t>& vertices, Make make, BaseOf base_of ) -> decltype( make( 0 ) ) {
+			static_assert( Options::KEEP_EDGES, "clone_component() requires STFOptions with KeepEdges" );
+			std::unordered_map<size_t, size_t> position;
+			const std::vector<NodeRef> tree = search_tree_nodes( v_idx, position );
+			const size_t k = tree.size();
+			auto copy = make( k );
+			STF& f = base_of( *copy );
+			copy_nodes( f.nodes, k, [&]( size_t i ) { return nodes.index_of( tree[i] ); }, [&]( size_t slot ) { return position.at( slot ); } );
+			
+			// Translate the edges to the vertices of the copy
+			f.neighbors.assign( k, std::vector<size_t>() );
+			for( size_t i = 0; i < k; i++ ) {
+				for( size_t w_idx : neighbors[get_index( tree[i] )] ) {
+					f.neighbors[i].push_back( position.at( slot_of( w_idx ) ) );
+				}
+				if( COUNTS_DEGREES ) {
+					f.degree[i] = f.neighbors[i].size();
+				}
+			}
+			f.relayout_interval = relayout_interval;
+			f.rebuild_depth = rebuild_depth;
+			f.update_max_depth();
+			vertices.resize( k );
+			for( size_t i = 0; i < k; i++ ) {
+				vertices[i] = get_index( tree[i] );
+			}
+			return copy;
+		}
+		
+		/* Accesses v. If this takes more than max_depth rotations, v was deeper than max_depth, since
+		 * each rotation decreases its depth by at most one. Then the next operation rebuilds its
+		 * search tree (see limit_depth()). Only with STFOptions with LimitDepth. */
+		inline void access( NodeRef v ) {
+			access( v, std::integral_constant<bool, Options::LIMIT_DEPTH>() );
+		}
+		
+		inline void access( NodeRef v, std::false_type ) {
+			AccessImpl::access( v );
+		}
+		
+		inline void access( NodeRef v, std::true_type ) {
+			if( !max_depth ) {
+				AccessImpl::access( v );
+				return;
+			}
+			rotations = 0;
+			rotation_counter() = &rotations;
+			AccessImpl::template access<CountingRotation<typename AccessImpl::Rotation>>( v );
+			if( rotations > max_depth ) {
+				deep_idx = get_index( v );
+			}
+		}
+		
+		/* If an access of the previous operation was deeper than max_depth (see access()), rebuilds
+		 * the search tree of that vertex with depth O(log n) (see build()) and returns the old root,
+		 * otherwise returns null. This cannot happen during the operation itself, which may rely on
+		 * the search tree between its accesses. A rebuild takes time linear in the size of the
+		 * component, but bounds the time of the following accesses, e.g. after a long path was
+		 * linked in order. */
+		inline NodeRef limit_depth() {
+			if( deep_idx == NONE ) {
+				return NodeRef();
+			}
+			NodeRef r = get_node( deep_idx )->get_stt_root();
+			rebuild_search_tree( deep_idx, []( const std::vector<NodeRef>& ) {}, []( NodeRef, size_t ) { return size_t( 1 ); } );
+			deep_idx = NONE;
+			return r;
+		}
+		
+		/// Sets max_depth to rebuild_depth log n (at least 1), or 0 if rebuild_depth is 0.
+		void update_max_depth() {
+			const double limit = rebuild_depth * std::log2( double( std::max<size_t>( nodes.size(), 2 ) ) );
+			max_depth = rebuild_depth > 0 ? std::max<size_t>( size_t( limit ), 1 ) : 0;
+		}
+		
+		/* Throws std::invalid_argument if some node has edges (i.e., a parent, since every component
+		 * with an edge has a non-root node), or if the edges contain a cycle, found with union-find. */
+		void check_build_edges( const std::vector<std::pair<size_t, size_t>>& edges ) {
+			const size_t n = nodes.size();
+			for( size_t v = 0; v < n; v++ ) {
+				if( get_node( v )->parent ) {
+					throw std::invalid_argument( "build(): nodes must be isolated" );
+				}
+			}
+			std::vector<size_t> set_of( n );
+			for( size_t v = 0; v < n; v++ ) {
+				set_of[v] = v;
+			}
+			auto find = [&]( size_t v ) {
+				while( set_of[v] != v ) {
+					set_of[v] = set_of[set_of[v]];
+					v = set_of[v];
+				}
+				return v;
+			};
+			for( const auto& e : edges ) {
+				if( e.first >= n || e.second >= n ) {
+					throw std::invalid_argument( "build(): no such node" );
+				}
+				const size_t a = find( e.first );
+				const size_t b = find( e.second );
+				if( a == b ) {
+					throw std::invalid_argument( "build(): edges contain a cycle" );
+				}
+				set_of[a] = b;
+			}
+		}
+		
+		// Adds or removes the edge between u and v in the adjacency lists and degrees, if they are kept.
+		void add_edge( size_t u_idx, size_t v_idx ) {
+			if( Options::KEEP_EDGES ) {
+				neighbors[u_idx].push_back( v_idx );
+				neighbors[v_idx].push_back( u_idx );
+			}
+			if( COUNTS_DEGREES ) {
+				degree[u_idx]++;
+				degree[v_idx]++;
+			}
+		}
+		
+		void remove_edge( size_t u_idx, size_t v_idx ) {
+			if( Options::KEEP_EDGES ) {
+				remove_neighbor( neighbors[u_idx], v_idx );
+				remove_neighbor( neighbors[v_idx], u_idx );
+			}
+			if( COUNTS_DEGREES ) {
+				degree[u_idx]--;
+				degree[v_idx]--;
+			}
+		}
+		
+		/* Makes u the root and v its child, if they are connected (and distinct). Then the inner
+		 * vertices of the path between u and v are exactly the separator descendants of the dsep
+		 * child of v. Returns whether u and v are connected. */
+		bool expose_path( NodeRef u, NodeRef v ) {
+			assert( u != v );
+			access( v );
+			access( u );
+			if( v->get_stt_root() != u ) {
+				return false;
+			}
+			rotate_to_root_child( v );
+			return true;
+		}
+		
+		/* Returns the vertex with distance k from u on the path from u to v, given that u is the
+		 * root and v its child (see expose_path()), or null if the path is shorter. Requires
+		 * SizeNode. */
+		NodeRef kth_on_exposed_path( NodeRef u, NodeRef v, size_t k ) {
+			if( k == 0 ) {
+				return u;
+			}
+			NodeRef x = v->dsep_child;
+			const size_t inner = x ? x->path_size : 0;
+			if( k > inner ) {
+				return k == inner + 1 ? v : NodeRef();
+			}
+			
+			/* The separator descendants of x in order from its parent to its other boundary vertex
+			 * are those of its dsep child in reverse, x, and those of its isep child. The inner
+			 * vertices of the path from u to v are those of v's dsep child in reverse. */
+			size_t i = k - 1;
+			bool reverse = true;
+			while( true ) {
+				NodeRef first = reverse ? x->isep_child : x->dsep_child;
+				NodeRef last = reverse ? x->dsep_child : x->isep_child;
+				const size_t first_size = first ? first->path_size : 0;
+				if( i < first_size ) {
+					x = first;
+					reverse = true;
+				}
+				else if( i == first_size ) {
+					return x;
+				}
+				else {
+					i -= first_size + 1;
+					x = last;
+					reverse = false;
+				}
+			}
+		}
+		
+	private :
+		// Moves the nodes, see relayout()
+		void relayout_nodes() {
+			const size_t n = nodes.size();
+			const std::vector<size_t> order = search_forest_order();
+			std::vector<size_t> new_slot( n );
+			for( size_t i = 0; i < n; i++ ) {
+				new_slot[order[i]] = i;
+			}
+			
+			Storage moved( n );
+			copy_nodes( moved, n, [&]( size_t i ) { return order[i]; }, [&]( size_t slot ) { return new_slot[slot]; } );
+			nodes.swap( moved );
+			
+			// Update node indices
+			if( slot_of_index.empty() ) {
+				slot_of_index = std::move( new_slot );
+			}
+			else {
+				for( size_t& slot : slot_of_index ) {
+					slot = new_slot[slot];
+				}
+			}
+			index_of_slot.resize( n );
+			for( size_t i = 0; i < n; i++ ) {
+				index_of_slot[slot_of_index[i]] = i;
+			}
+		}
+		
+		/* Builds search trees for the vertices 0, ..., n - 1 and the given edges between them (see
+		 * build()), where node_of(u) is the isolated node of u, and weight_of(u) its positive weight.
+		 * The root of each search subtree then splits the weight of its segment in half. Calls
+		 * finish(placed) with the nodes, parents before children, before their payload is rebuilt. */
+		template<typename NodeOf, typename WeightOf, typename Finish>
+		void build_search_trees( size_t n, const std::vector<std::pair<size_t, size_t>>& edges, NodeOf node_of, WeightOf weight_of, Finish finish ) {
+			typedef decltype( weight_of( 0 ) ) Weight;
+			const size_t NONE = size_t( -1 );
+			
+			// Adjacency lists, stored consecutively
+			std::vector<size_t> first_edge( n + 1, 0 );
+			for( const auto& e : edges ) {
+				first_edge[e.first + 1]++;
+				first_edge[e.second + 1]++;
+			}
+			for( size_t v = 0; v < n; v++ ) {
+				first_edge[v + 1] += first_edge[v];
+			}
+			std::vector<size_t> neighbors( first_edge[n] );
+			{
+				std::vector<size_t> next( first_edge.begin(), first_edge.end() - 1 );
+				for( const auto& e : edges ) {
+					neighbors[next[e.first]++] = e.second;
+					neighbors[next[e.second]++] = e.first;
+				}
+			}
+			
+			/* Root each tree at its smallest vertex, and number the vertices in BFS order. The rest
+			 * works on these ranks, since the children of each vertex have consecutive ranks. */
+			std::vector<size_t> vertex_at( n );
+			std::vector<size_t> children_begin( n );
+			std::vector<size_t> children_end( n );
+			std::vector<bool> is_root( n, false );
+			{
+				std::vector<size_t> rank( n, NONE );
+				size_t next_rank = 0;
+				for( size_t s = 0; s < n; s++ ) {
+					if( rank[s] != NONE ) {
+						continue;
+					}
+					is_root[next_rank] = true;
+					rank[s] = next_rank;
+					vertex_at[next_rank++] = s;
+					for( size_t i = rank[s]; i < next_rank; i++ ) {
+						const size_t u = vertex_at[i];
+						children_begin[i] = next_rank;
+						for( size_t j = first_edge[u]; j < first_edge[u + 1]; j++ ) {
+							const size_t w = neighbors[j];
+							if( rank[w] == NONE ) {
+								rank[w] = next_rank;
+								vertex_at[next_rank++] = w;
+							}
+						}
+						children_end[i] = next_rank;
+					}
+				}
+			}
+			
+			// Subtree weights, heavy children, and the length of the heavy path starting at each vertex
+			std::vector<Weight> size( n );
+			std::vector<size_t> heavy( n, NONE );
+			std::vector<size_t> path_length( n, 1 );
+			for( size_t r = n; r-- > 0; ) {
+				size[r] = weight_of( vertex_at[r] );
+				for( size_t c = children_begin[r]; c < children_end[r]; c++ ) {
+					size[r] += size[c];
+					if( heavy[r] == NONE || size[c] > size[heavy[r]] ) {
+						heavy[r] = c;
+					}
+				}
+				if( heavy[r] != NONE ) {
+					path_length[r] += path_length[heavy[r]];
+				}
+			}
+			
+			/* Order the ranks by DFS, visiting heavy children first, so that each heavy path is stored
+			 * consecutively. Keep prefix sums of the weights of the path vertices, including their
+			 * subtrees without the rest of the path. */
+			std::vector<size_t> rank_at( n );
+			std::vector<size_t> position( n );
+			std::vector<Weight> prefix( n + 1, Weight() );
+			{
+				std::vector<size_t> stack;
+				size_t next_position = 0;
+				for( size_t root = 0; root < n; root++ ) {
+					if( !is_root[root] ) {
+						continue;
+					}
+					stack.push_back( root );
+					while( !stack.empty() ) {
+						const size_t r = stack.back();
+						stack.pop_back();
+						rank_at[next_position] = r;
+						position[r] = next_position;
+						prefix[next_position + 1] = prefix[next_position] + size[r] - ( heavy[r] != NONE ? size[heavy[r]] : 0 );
+						next_position++;
+						for( size_t c = children_begin[r]; c < children_end[r]; c++ ) {
+							if( c != heavy[r] ) {
+								stack.push_back( c );
+							}
+						}
+						if( heavy[r] != NONE ) {
+							stack.push_back( heavy[r] );
+						}
+					}
+				}
+			}
+			
+			/* Segment [first, last] of a heavy path, whose search tree is to be built below parent, with
+			 * the ranks of the neighbors of its ends on the path (or NONE), which are its boundary vertices */
+			struct Segment {
+				size_t first;
+				size_t last;
+				size_t top;
+				size_t bottom;
+				size_t parent;
+				NodeSepType type;
+			};
+			std::vector<Segment> todo;
+			std::vector<NodeRef> placed; // Parents before children
+			placed.reserve( n );
+			std::vector<NodeRef> node_at_rank( n );
+			for( size_t root = 0; root < n; root++ ) {
+				if( is_root[root] ) {
+					todo.push_back( Segment{ position[root], position[root] + path_length[root] - 1, NONE, NONE, NONE, NOSEP } );
+				}
+			}
+			while( !todo.empty() ) {
+				const Segment t = todo.back();
+				todo.pop_back();
+				
+				/* Find the first position m such that the weight after m is at most half of the total.
+				 * Searching from both ends takes time logarithmic in the smaller part. */
+				const Weight half = ( prefix[t.last + 1] - prefix[t.first] ) / 2;
+				auto is_after = [&]( size_t m ) { return prefix[t.last + 1] - prefix[m + 1] <= half; };
+				size_t lo = t.first;
+				size_t hi = t.last;
+				for( size_t step = 1; lo < hi; step *= 2 ) {
+					const size_t front = t.first + step - 1;
+					if( front >= hi ) {
+						break;
+					}
+					if( is_after( front ) ) {
+						hi = front;
+						break;
+					}
+					lo = front + 1;
+					if( t.last - lo < step ) {
+						break;
+					}
+					const size_t back = t.last - step;
+					if( !is_after( back ) ) {
+						lo = back + 1;
+						break;
+					}
+					hi = back;
+				}
+				while( lo < hi ) {
+					const size_t mid = lo + ( hi - lo ) / 2;
+					if( is_after( mid ) ) {
+						hi = mid;
+					}
+					else {
+						lo = mid + 1;
+					}
+				}
+				const size_t r = rank_at[lo];
+				
+				NodeRef v = node_of( vertex_at[r] );
+				node_at_rank[r] = v;
+				placed.push_back( v );
+				v->push_lazy( v ); // Pending updates of isolated nodes only concern themselves
+				if( t.parent != NONE ) {
+					NodeRef p = node_at_rank[t.parent];
+					v->parent = p;
+					v->set_sep_type( t.type );
+					if( t.type == DSEP ) {
+						p->dsep_child = v;
+					}
+					else if( t.type == ISEP ) {
+						p->isep_child = v;
+					}
+				}
+				
+				auto type_towards = [&]( size_t boundary ) {
+					return boundary == NONE ? NOSEP : boundary == t.parent ? DSEP : ISEP;
+				};
+				if( lo > t.first ) {
+					todo.push_back( Segment{ t.first, lo - 1, t.top, r, r, type_towards( t.top ) } );
+				}
+				if( lo < t.last ) {
+					todo.push_back( Segment{ lo + 1, t.last, r, t.bottom, r, type_towards( t.bottom ) } );
+				}
+				for( size_t c = children_begin[r]; c < children_end[r]; c++ ) {
+					if( c != heavy[r] ) {
+						todo.push_back( Segment{ position[c], position[c] + path_length[c] - 1, r, NONE, r, NOSEP } );
+					}
+				}
+			}
+			
+			finish( placed );
+			for( size_t i = placed.size(); i-- > 0; ) {
+				placed[i]->rebuild_payload();
+			}
+		}
+		
+		/* Rebuilds the search tree of v's component with build_search_trees(), using weight_of(x, k)
+		 * as the weight of node x, where k is the size of the component. Calls prepare(tree) with
+		 * the nodes of the search tree first. */
+		template<typename Prepare, typename WeightOf>
+		void rebuild_search_tree( size_t v_idx, Prepare prepare, WeightOf weight_of ) {
+			std::unordered_map<size_t, size_t> position;
+			const std::vector<NodeRef> tree = search_tree_nodes( v_idx, position );
+			const size_t k = tree.size();
+			prepare( tree );
+			
+			// Apply pending updates top-down, and translate the edges of the component
+			std::vector<std::pair<size_t, size_t>> edges;
+			edges.reserve( k - 1 );
+			for( size_t i = 0; i < k; i++ ) {
+				tree[i]->push_lazy( tree[i] );
+				for( size_t w_idx : neighbors[get_index( tree[i] )] ) {
+					const size_t j = position.at( slot_of( w_idx ) );
+					if( i < j ) {
+						edges.emplace_back( i, j );
+					}
+				}
+			}
+			
+			replace_search_tree( tree, position, edges, [&]( size_t u ) { return weight_of( tree[u], k ); },
+					std::integral_constant<bool, decltype( node_type_of( NodeRef() ) )::HAS_EDGE_WEIGHTS>() );
+		}
+		
+		/* Replaces the search tree with the given nodes (parents before children, with positions as
+		 * in search_tree_nodes()) by one built for the given edges between the positions, keeping
+		 * the edge weights if there are any. */
+		template<typename WeightOf>
+		void replace_search_tree( const std::vector<NodeRef>& tree, const std::unordered_map<size_t, size_t>&, const std::vector<std::pair<size_t, size_t>>& edges, WeightOf weight_of, std::false_type ) {
+			clear_search_tree( tree );
+			build_search_trees( tree.size(), edges, [&]( size_t u ) { return tree[u]; }, weight_of, []( const std::vector<NodeRef>& ) {} );
+		}
+		
+		/* Each non-root node x has the weight of the edge between its parent and the end of that edge
+		 * in its subtree (see parent_edge_ends()). These are stored by edge and assigned to the new
+		 * nodes after the rebuild. */
+		template<typename WeightOf>
+		void replace_search_tree( const std::vector<NodeRef>& tree, const std::unordered_map<size_t, size_t>& position, const std::vector<std::pair<size_t, size_t>>& edges, WeightOf weight_of, std::true_type ) {
+			const size_t k = tree.size();
+			auto vertex_of = [&]( NodeRef x ) { return position.at( nodes.index_of( x ) ); };
+			auto edge_key = [k]( size_t u, size_t w ) { return std::min( u, w ) * k + std::max( u, w ); };
+			std::vector<size_t> end( k );
+			std::unordered_map<size_t, decltype( tree[0]->weight )> edge_weights;
+			parent_edge_ends( tree, vertex_of, end );
+			for( NodeRef x : tree ) {
+				if( x->parent ) {
+					edge_weights[edge_key( end[vertex_of( x )], vertex_of( x->parent ) )] = x->weight;
+				}
+			}
+			clear_search_tree( tree );
+			build_search_trees( k, edges, [&]( size_t u ) { return tree[u]; }, weight_of, [&]( const std::vector<NodeRef>& placed ) {
+				parent_edge_ends( placed, vertex_of, end );
+				for( NodeRef x : placed ) {
+					if( x->parent ) {
+						x->weight = edge_weights.at( edge_key( end[vertex_of( x )], vertex_of( x->parent ) ) );
+					}
+				}
+			} );
+		}
+		
+		/* Stores in end[u] the vertex of the subtree of each node (with vertex u = vertex_of(x)) that
+		 * is adjacent to its parent: the node itself if it has no dsep child, and otherwise the last
+		 * node on the isep chain from its dsep child. The nodes are given parents before children. */
+		template<typename VertexOf>
+		static void parent_edge_ends( const std::vector<NodeRef>& order, VertexOf vertex_of, std::vector<size_t>& end ) {
+			std::vector<size_t> chain_end( end.size() );
+			for( size_t i = order.size(); i-- > 0; ) {
+				NodeRef x = order[i];
+				const size_t u = vertex_of( x );
+				chain_end[u] = x->isep_child ? chain_end[vertex_of( x->isep_child )] : u;
+				end[u] = x->dsep_child ? chain_end[vertex_of( x->dsep_child )] : u;
+			}
+		}
+		
+		// Makes the given nodes isolated, and resets their derived data
+		static void clear_search_tree( const std::vector<NodeRef>& tree ) {
+			for( NodeRef x : tree ) {
+				x->parent = NodeRef();
+				x->dsep_child = NodeRef();
+				x->isep_child = NodeRef();
+				x->set_sep_type( NOSEP );
+				x->clear_derived_payload();
+			}
+		}
+		
+		// Whether nodes can be copied as they are, with all derived data (see copy_nodes())
+		static const bool BYTEWISE_COPY = std::is_pointer<NodeRef>::value && std::is_trivially_copyable<Node>::value;
+		
+		// Whether copied nodes have to recompute derived data, and therefore be copied parents first
+		static const bool COPY_REBUILDS_PAYLOAD = !BYTEWISE_COPY &&
+				( decltype( node_type_of( NodeRef() ) )::HAS_AGGREGATE || decltype( node_type_of( NodeRef() ) )::HAS_COMPONENT_AGGREGATE );
+		
+		/* Copies the nodes at the slots slot_at( 0 ), ..., slot_at( k - 1 ) of this forest to the
+		 * slots new_slot( s ) of to, where s is the old slot. The links must not leave these nodes.
+		 * Nodes that cannot be copied bytewise recompute their derived data (see copy_payload() and
+		 * rebuild_payload()), for which the slots must be given parents before children, if they
+		 * have any. */
+		template<typename SlotAt, typename NewSlot>
+		void copy_nodes( Storage& to, size_t k, SlotAt slot_at, NewSlot new_slot ) {
+			auto translate = [&]( NodeRef x ) { return x ? to.get( new_slot( nodes.index_of( x ) ) ) : NodeRef(); };
+			for( size_t i = 0; i < k; i++ ) {
+				const size_t slot = slot_at( i );
+				NodeRef v = nodes.get( slot );
+				NodeRef w = to.get( new_slot( slot ) );
+				copy_node( w, v, std::integral_constant<bool, BYTEWISE_COPY>() );
+				w->parent = translate( v->parent );
+				w->dsep_child = translate( v->dsep_child );
+				w->isep_child = translate( v->isep_child );
+			}
+			if( COPY_REBUILDS_PAYLOAD ) {
+				for( size_t i = k; i-- > 0; ) {
+					to.get( new_slot( slot_at( i ) ) )->rebuild_payload();
+				}
+			}
+		}
+		
+		// Copies everything, the links are translated afterwards
+		static inline void copy_node( NodeRef w, NodeRef v, std::true_type ) {
+			*w = *v;
+		}
+		
+		static inline void copy_node( NodeRef w, NodeRef v, std::false_type ) {
+			w->set_sep_type( v->stored_sep_type() );
+			w->copy_payload( v );
+		}
+		
+		/* Returns the slots of all nodes in DFS order of their search trees, so parents come before
+		 * their children. */
+		std::vector<size_t> search_forest_order() {
+			const size_t n = nodes.size();
+			std::vector<size_t> first_child, next_sibling;
+			search_tree_children( first_child, next_sibling );
+			std::vector<size_t> order;
+			order.reserve( n );
+			for( size_t r = 0; r < n; r++ ) {
+				if( !nodes.get( r )->parent ) {
+					append_search_tree( r, first_child, next_sibling, order );
+				}
+			}
+			assert( order.size() == n );
+			return order;
+		}
+		
+		/* Returns the nodes of the search tree of v's component, parents before children, and stores
+		 * the position of each node in the result by storage slot. Takes time linear in the size of
+		 * the component, since the vertices are found with the kept edges (see STFOptions). */
+		std::vector<NodeRef> search_tree_nodes( size_t v_idx, std::unordered_map<size_t, size_t>& position ) {
+			// Find the vertices by DFS in the tree, numbered in the order they are found
+			std::vector<NodeRef> found( 1, get_node( v_idx ) );
+			std::vector<size_t> stack( 1, v_idx );
+			position.clear();
+			position[slot_of( v_idx )] = 0;
+			while( !stack.empty() ) {
+				const size_t u_idx = stack.back();
+				stack.pop_back();
+				for( size_t w_idx : neighbors[u_idx] ) {
+					if( position.emplace( slot_of( w_idx ), found.size() ).second ) {
+						found.push_back( get_node( w_idx ) );
+						stack.push_back( w_idx );
+					}
+				}
+			}
+			
+			// Order them such that each node comes after its ancestors in the search tree
+			const size_t k = found.size();
+			std::vector<NodeRef> tree;
+			tree.reserve( k );
+			std::vector<bool> placed( k, false );
+			std::vector<size_t> path;
+			for( size_t i = 0; i < k; i++ ) {
+				for( size_t j = i; !placed[j]; ) {
+					placed[j] = true;
+					path.push_back( j );
+					NodeRef p = found[j]->parent;
+					if( !p ) {
+						break;
+					}
+					j = position.at( nodes.index_of( p ) );
+				}
+				for( ; !path.empty(); path.pop_back() ) {
+					tree.push_back( found[path.back()] );
+				}
+			}
+			for( size_t i = 0; i < k; i++ ) {
+				position[nodes.index_of( tree[i] )] = i;
+			}
+			return tree;
+		}
+		
+		/* Lists the children of each node by storage slot (NONE-terminated), since only separator
+		 * children are linked from their parent. */
+		void search_tree_children( std::vector<size_t>& first_child, std::vector<size_t>& next_sibling ) {
+			const size_t n = nodes.size();
+			const size_t NONE = size_t( -1 );
+			first_child.assign( n, NONE );
+			next_sibling.assign( n, NONE );
+			for( size_t i = n; i-- > 0; ) {
+				NodeRef p = nodes.get( i )->parent;
+				if( p ) {
+					const size_t p_slot = nodes.index_of( p );
+					next_sibling[i] = first_child[p_slot];
+					first_child[p_slot] = i;
+				}
+			}
+		}
+		
+		/* Whether v has no edges. A search tree root can have non-separator children, which it does
+		 * not link to, so this takes linear time unless the degrees or edges are kept. */
+		bool is_isolated( size_t v_idx ) {
+			if( COUNTS_DEGREES ) {
+				return degree[v_idx] == 0;
+			}
+			NodeRef v = get_node( v_idx );
+			if( v->parent ) {
+				return false;
+			}
+			if( Options::KEEP_EDGES ) {
+				return neighbors[v_idx].empty();
+			}
+			for( size_t i = 0; i < nodes.size(); i++ ) {
+				if( nodes.get( i )->parent == v ) {
+					return false;
+				}
+			}
+			return true;
+		}
+		
+		// Removes v from the given adjacency list, where it must occur.
+		static void remove_neighbor( std::vector<size_t>& list, size_t v_idx ) {
+			auto it = std::find( list.begin(), list.end(), v_idx );
+			assert( it != list.end() );
+			*it = list.back();
+			list.pop_back();
+		}
+		
+		inline size_t slot_of( size_t idx ) const {
+			return !Options::RELAYOUT || slot_of_index.empty() ? idx : slot_of_index[idx];
+		}
+		
+		// Appends the slots of the search tree with root slot r to order, in DFS order
+		static void append_search_tree( size_t r, const std::vector<size_t>& first_child, const std::vector<size_t>& next_sibling, std::vector<size_t>& order ) {
+			const size_t NONE = size_t( -1 );
+			std::vector<size_t> stack( 1, r );
+			while( !stack.empty() ) {
+				const size_t v = stack.back();
+				stack.pop_back();
+				order.push_back( v );
+				for( size_t c = first_child[v]; c != NONE; c = next_sibling[c] ) {
+					stack.push_back( c );
+				}
+			}
+		}
+		
+		Storage nodes;
+		
+		// Storage slot of each node index and vice versa. Empty until the first relayout().
+		std::vector<size_t> slot_of_index;
+		std::vector<size_t> index_of_slot;
+		
+		// Indices of removed nodes, see add_node()
+		std::vector<size_t> free_indices;
+		
+		// Whether each node index is removed (not resized before the first remove_node())
+		std::vector<bool> removed;
+		
+		size_t relayout_interval;
+		size_t ops_until_relayout;
+		
+		// Accesses deeper than max_depth rebuild the search tree, see limit_depth()
+		double rebuild_depth;
+		size_t max_depth;
+		size_t deep_idx; // Vertex of such an access in the current operation, or NONE
+		size_t rotations; // Rotations of the current access, counted by CountingRotation
+		
+		// Adjacency lists of the forest, with STFOptions with KeepEdges
+		std::vector<std::vector<size_t>> neighbors;
+		
+		// Number of edges of each vertex, for remove_node() with a storage that can grow
+		static const bool COUNTS_DEGREES = is_growable_storage<Storage>::value;
+		std::vector<size_t> degree;
+	};
+
+	/* Forest of rooted trees, using the same search trees as STF. The root of each tree is only
+	 * stored at the search tree root of its component, and moved along on each access. */
+	template<typename AccessImpl, typename Storage = DefaultStorage, typename Options = STFOptions<>>
+	class RootedSTF : private STF<AccessImpl, Storage, Options> {
+		typedef STF<AccessImpl, Storage, Options> Base;
+		
+	public :
+		typedef typename Storage::NodeRef NodeRef;
+		
+		/// Returned by parent() and lca() if there is no such vertex.
+		static const size_t NONE = size_t( -1 );
+		
+		explicit RootedSTF( size_t n ) : Base( n ), tree_root( n ) {
+			for( size_t i = 0; i < n; i++ ) {
+				tree_root[i] = i;
+			}
+		}
+		
+		using Base::get_node;
+		using Base::get_index;
+		using Base::num_nodes;
+		using Base::relayout;
+		using Base::remove_node;
+		
+		/// Returns a copy of this forest with the same node indices (see STF::clone()).
+		std::unique_ptr<RootedSTF> clone() {
+			std::unique_ptr<RootedSTF> copy( new RootedSTF( num_nodes() ) );
+			Base::clone_into( *copy );
+			copy->tree_root = tree_root;
+			return copy;
+		}
+		
+		/// Returns a forest with a copy of the tree containing v only (see STF::clone_component()).
+		std::unique_ptr<RootedSTF> clone_component( size_t v_idx, std::vector<size_t>& vertices ) {
+			const size_t r_idx = tree_root[get_index( get_node( v_idx )->get_stt_root() )];
+			std::unique_ptr<RootedSTF> copy = Base::clone_component( v_idx, vertices,
+					[]( size_t k ) { return std::unique_ptr<RootedSTF>( new RootedSTF( k ) ); }, []( RootedSTF& f ) -> Base& { return f; } );
+			// The search tree root is copied first
+			copy->tree_root[0] = std::find( vertices.begin(), vertices.end(), r_idx ) - vertices.begin();
+			return copy;
+		}
+		
+		/// Rebuilds the search tree of v's component for the given access weights (see STF::rebuild()).
+		void rebuild( size_t v_idx, const std::vector<double>& access_weights ) {
+			const size_t r_idx = rooted_access( v_idx );
+			Base::rebuild( v_idx, access_weights );
+			tree_root[get_index( get_node( v_idx )->get_stt_root() )] = r_idx;
+		}
+		
+		/* Adds the given edges, where the first vertex of each edge becomes a child of the second, if
+		 * all nodes are isolated (see STF::build()). Also throws std::invalid_argument if a vertex
+		 * would get two parents. */
+		void build( const std::vector<std::pair<size_t, size_t>>& edges ) {
+			std::vector<bool> has_parent( num_nodes(), false );
+			for( const auto& e : edges ) {
+				if( e.first < num_nodes() ) { // Other vertices are rejected by STF::build()
+					if( has_parent[e.first] ) {
+						throw std::invalid_argument( "build(): vertex has two parents" );
+					}
+					has_parent[e.first] = true;
+				}
+			}
+			Base::build( edges );
+			for( size_t v = 0; v < num_nodes(); v++ ) {
+				if( !has_parent[v] ) {
+					tree_root[get_index( get_node( v )->get_stt_root() )] = v;
+				}
+			}
+		}
+		
+		/// Adds an isolated node, which is the root of its tree (see STF::add_node()).
+		size_t add_node() {
+			const size_t idx = Base::add_node();
+			if( idx == tree_root.size() ) {
+				tree_root.push_back( idx );
+			}
+			else {
+				tree_root[idx] = idx;
+			}
+			return idx;
+		}
+		
+		/// Makes u, which must be the root of its tree, a child of v.
+		void link( size_t u_idx, size_t v_idx ) {
+			count_operation();
+			const size_t r_idx = rooted_access( v_idx );
+			NodeRef u = get_node( u_idx );
+			NodeRef v = get_node( v_idx );
+			assert( tree_root[get_index( u->get_stt_root() )] == u_idx );
+			this->access( u );
+			this->access( v ); // v stays the search tree root
+			u->attach( v );
+			this->add_edge( u_idx, v_idx );
+			tree_root[v_idx] = r_idx;
+		}
+		
+		/// Removes the edge between v and its parent, which must exist.
+		void cut_from_parent( size_t v_idx ) {
+			count_operation();
+			const size_t r_idx = rooted_access( v_idx );
+			NodeRef p = expose_parent( get_node( v_idx ), r_idx );
+			assert( p );
+			p->detach();
+			this->remove_edge( v_idx, get_index( p ) );
+			tree_root[get_index( p )] = r_idx;
+			tree_root[v_idx] = v_idx;
+		}
+		
+		/// Returns the parent of v, or NONE if v is a root.
+		size_t parent( size_t v_idx ) {
+			count_operation();
+			NodeRef p = expose_parent( get_node( v_idx ), rooted_access( v_idx ) );
+			return p ? get_index( p ) : NONE;
+		}
+		
+		size_t find_root( size_t v_idx ) {
+			count_operation();
+			return rooted_access( v_idx );
+		}
+		
+		/* Returns the ancestor of v with distance k (v itself if k = 0), or NONE if v has fewer than
+		 * k ancestors. Requires SizeNode. */
+		template<typename N = typename Base::Node>
+		size_t ancestor( size_t v_idx, size_t k ) {
+			static_assert( N::HAS_SUBTREE_SIZE, "ancestor() requires SizeNode" );
+			count_operation();
+			const size_t r_idx = rooted_access( v_idx );
+			if( r_idx == v_idx ) {
+				return k == 0 ? v_idx : NONE;
+			}
+			NodeRef v = get_node( v_idx );
+			NodeRef r = get_node( r_idx );
+			expose_with_child( v_idx, r_idx );
+			NodeRef a = this->kth_on_exposed_path( v, r, k );
+			if( !a ) {
+				return NONE;
+			}
+			const size_t a_idx = get_index( a );
+			rooted_access( a_idx ); // Pay for the search
+			return a_idx;
+		}
+		
+		/// Marks or unmarks v. Requires MarkNode, as does nearest_marked_ancestor().
+		template<typename N = typename Base::Node>
+		void set_marked( size_t v_idx, bool marked ) {
+			static_assert( N::HAS_MARKS, "set_marked() requires MarkNode" );
+			count_operation();
+			rooted_access( v_idx );
+			NodeRef v = get_node( v_idx );
+			v->marked = marked;
+			v->update_marks();
+		}
+		
+		template<typename N = typename Base::Node>
+		void mark( size_t v_idx ) { set_marked<N>( v_idx, true ); }
+		
+		template<typename N = typename Base::Node>
+		void unmark( size_t v_idx ) { set_marked<N>( v_idx, false ); }
+		
+		/// Returns the nearest marked ancestor of v, which may be v itself, or NONE if there is none.
+		template<typename N = typename Base::Node>
+		size_t nearest_marked_ancestor( size_t v_idx ) {
+			static_assert( N::HAS_MARKS, "nearest_marked_ancestor() requires MarkNode" );
+			count_operation();
+			const size_t r_idx = rooted_access( v_idx );
+			NodeRef v = get_node( v_idx );
+			NodeRef r = get_node( r_idx );
+			if( v->marked || v == r ) {
+				return v->marked ? v_idx : NONE;
+			}
+			
+			// Find the first marked vertex on the path from v to r (see STF::kth_on_exposed_path())
+			expose_with_child( v_idx, r_idx );
+			NodeRef x = r->dsep_child;
+			if( !x || x->path_marked == 0 ) {
+				return r->marked ? r_idx : NONE;
+			}
+			bool reverse = true;
+			while( true ) {
+				NodeRef first = reverse ? x->isep_child : x->dsep_child;
+				NodeRef last = reverse ? x->dsep_child : x->isep_child;
+				if( first && first->path_marked > 0 ) {
+					x = first;
+					reverse = true;
+				}
+				else if( x->marked ) {
+					break;
+				}
+				else {
+					x = last;
+					reverse = false;
+				}
+			}
+			const size_t a_idx = get_index( x );
+			rooted_access( a_idx ); // Pay for the search
+			return a_idx;
+		}
+		
+		/// Makes v the root of its tree.
+		void evert( size_t v_idx ) {
+			count_operation();
+			rooted_access( v_idx );
+			tree_root[v_idx] = v_idx;
+		}
+		
+		/// Number of vertices in the subtree rooted at v. Requires SizeNode.
+		template<typename N = typename Base::Node>
+		size_t subtree_size( size_t v_idx ) {
+			static_assert( N::HAS_SUBTREE_SIZE, "subtree_size() requires SizeNode" );
+			count_operation();
+			NodeRef v = get_node( v_idx );
+			// With v as search tree root, the subtree of its parent p consists of all vertices outside of v's subtree
+			NodeRef p = expose_parent( v, rooted_access( v_idx ) );
+			return p ? v->size - p->size : v->size;
+		}
+		
+		/// Number of vertices in the tree containing v. Requires SizeNode.
+		template<typename N = typename Base::Node>
+		size_t component_size( size_t v_idx ) {
+			static_assert( N::HAS_SUBTREE_SIZE, "component_size() requires SizeNode" );
+			count_operation();
+			rooted_access( v_idx );
+			return get_node( v_idx )->size;
+		}
+		
+		bool is_connected( size_t u_idx, size_t v_idx ) {
+			count_operation();
+			rooted_access( u_idx );
+			rooted_access( v_idx );
+			return get_node( u_idx )->get_stt_root() == get_node( v_idx );
+		}
+		
+		/// Returns the lowest common ancestor of u and v, or NONE if they are not connected.
+		size_t lca( size_t u_idx, size_t v_idx ) {
+			count_operation();
+			const size_t r_idx = rooted_access( u_idx );
+			NodeRef r = get_node( r_idx );
+			NodeRef u = get_node( u_idx );
+			NodeRef v = get_node( v_idx );
+			if( u == r ) {
+				rooted_access( v_idx );
+				return u->get_stt_root() == v ? r_idx : NONE;
+			}
+			expose_with_child( r_idx, u_idx );
+			
+			/* The path from u to r consists of u, r, and the separator descendants of u's dsep child
+			 * (see expose_parent()). The lca is the lowest ancestor of v on that path. */
+			NodeRef a = v;
+			NodeRef x = v;
+			for( ; x != u && x->parent; x = x->parent ) {
+				NodeRef p = x->parent;
+				if( p == u ? p->dsep_child != x : !x->is_separator_hint( p ) ) {
+					a = p;
+				}
+			}
+			rooted_access( v_idx ); // Pay for the search
+			return x != u && x != r ? NONE : get_index( a );
+		}
+		
+	private :
+		// Counts an operation (see STF::count_operation()), keeping the root of a rebuilt tree.
+		void count_operation() {
+			NodeRef old_root = Options::LIMIT_DEPTH ? Base::limit_depth() : NodeRef();
+			if( old_root ) {
+				tree_root[get_index( old_root->get_stt_root() )] = tree_root[get_index( old_root )];
+			}
+			Base::count_operation();
+		}
+		
+		// Accesses v and moves the root of its tree along. Returns that root.
+		size_t rooted_access( size_t v_idx ) {
+			NodeRef v = get_node( v_idx );
+			const size_t r_idx = tree_root[get_index( v->get_stt_root() )];
+			this->access( v );
+			tree_root[v_idx] = r_idx;
+			return r_idx;
+		}
+		
+		/* Makes v the search tree root and x a child of it. Accessing x first bounds the rotations of
+		 * x by those of the following access of v, which moves x down by at most one per rotation. */
+		void expose_with_child( size_t v_idx, size_t x_idx ) {
+			rooted_access( x_idx );
+			rooted_access( v_idx );
+			rotate_to_root_child( get_node( x_idx ) );
+		}
+		
+		/* Given the search tree root v and the root r of its tree, returns the parent p of v (or null
+		 * if v = r) and makes it a child of v. Rotating r to depth 1 first exposes the path from r to
+		 * v: it consists of r, the separator descendants of r's dsep child, and v, and the vertex
+		 * next to v is the last one in isep direction. Finding it is paid for by an access of p. */
+		NodeRef expose_parent( NodeRef v, size_t r_idx ) {
+			assert( !v->parent );
+			NodeRef r = get_node( r_idx );
+			if( r == v ) {
+				return NodeRef();
+			}
+			const size_t v_idx = get_index( v );
+			expose_with_child( v_idx, r_idx );
+			NodeRef p = r->dsep_child;
+			if( !p ) {
+				return r;
+			}
+			while( p->isep_child ) {
+				p = p->isep_child;
+			}
+			expose_with_child( v_idx, get_index( p ) );
+			return p;
+		}
+		
+		// Root of each tree, only valid at the search tree root of its component
+		std::vector<size_t> tree_root;
+	};
+	
+	template<typename AccessImpl, typename Storage, typename Options>
+	void _write_tree( std::ostream& os, STF<AccessImpl, Storage, Options>& f, size_t v_idx, const std::vector<std::vector<size_t>>& node_children, const std::string& indent = "" ) {
+		if( indent.length() >= 1000 ) {
+			std::cerr << "Refusing to write tree of depth >= 1000\n";
+			exit( -1 );
+		}
+		auto v = f.get_node( v_idx );
+		os << indent << v_idx;
+		// os << "[" << v << "]";
+		if( v->parent && v->parent->dsep_child == v ) { os << "d"; }
+		else if( v->parent && v->parent->isep_child == v ) { os << "i"; }
+		os << "\n";
+		for( const size_t c_idx : node_children[v_idx] ) {
+			_write_tree( os, f, c_idx, node_children, indent + "  " );
+		}
+	}
+
+	template<typename AccessImpl, typename Storage, typename Options>
+	std::ostream& operator<<( std::ostream& os, STF<AccessImpl, Storage, Options>& f ) {
+		std::vector<std::vector<size_t>> node_children( f.num_nodes() );
+		for( size_t i = 0; i < f.num_nodes(); i++ ) {
+			auto v = f.get_node( i );
+			if( v->parent ) {
+				node_children[f.get_index( v->parent )].push_back( i );
+			}
+		}
+		for( size_t i = 0; i < f.num_nodes(); i++ ) {
+			if( f.get_node( i )->parent == nullptr ) {
+				_write_tree( os, f, i, node_children );
+			}
+		}
+		return os;
+	}
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef STT_IMPL_H
+#define STT_IMPL_H
+
+#include <string>
+#include <vector>
+
+#include "parse_input.h"
+#include "stt.h"
+
+namespace stt {
+	// Whether the options of the executables need an STF with MaintainedOptions (see handle_option())
+	inline bool maintenance_requested() {
+		return default_relayout_interval() > 0 || default_rebuild_depth() > 0;
+	}
+	
+	/* Runs the queries with STF<AccessImpl> and RootedSTF<AccessImpl>, or with MaintainedOptions if
+	 * --relayout-every or --rebuild-depth is given, so that the other runs do not pay for them. */
+	template<typename AccessImpl>
+	struct STTImpl {
+		typedef STF<AccessImpl> Plain;
+		typedef STF<AccessImpl, DefaultStorage, MaintainedOptions> Maintained;
+		typedef RootedSTF<AccessImpl> RootedPlain;
+		typedef RootedSTF<AccessImpl, DefaultStorage, MaintainedOptions> RootedMaintained;
+		
+		static bool bench( size_t num_vertices, const std::vector<Query>& queries, size_t repeat, bool json, const char* algo_name ) {
+			return maintenance_requested()
+					? bench_queries<Maintained>( num_vertices, queries, repeat, json, algo_name )
+					: bench_queries<Plain>( num_vertices, queries, repeat, json, algo_name );
+		}
+		
+		static bool compute( size_t num_vertices, const std::vector<Query>& queries, const std::vector<long>& old_labels ) {
+			return maintenance_requested()
+					? compute_queries<Maintained>( num_vertices, queries, old_labels )
+					: compute_queries<Plain>( num_vertices, queries, old_labels );
+		}
+		
+		static bool bench_rooted( size_t num_vertices, const std::vector<Query>& queries, size_t repeat, bool json, const char* algo_name ) {
+			return maintenance_requested()
+					? bench_rooted_queries<RootedMaintained>( num_vertices, queries, repeat, json, algo_name )
+					: bench_rooted_queries<RootedPlain>( num_vertices, queries, repeat, json, algo_name );
+		}
+		
+		static bool compute_rooted( size_t num_vertices, const std::vector<Query>& queries, const std::vector<long>& old_labels ) {
+			return maintenance_requested()
+					? compute_rooted_queries<RootedMaintained>( num_vertices, queries, old_labels )
+					: compute_rooted_queries<RootedPlain>( num_vertices, queries, old_labels );
+		}
+	};
+	
+	/// Named implementation for main_connectivity() with the given access implementation (see STTImpl).
+	template<typename AccessImpl>
+	NamedImpl named_stt_impl( const std::string& name ) {
+		typedef STTImpl<AccessImpl> Impl;
+		return NamedImpl{ name, Impl::bench, Impl::compute, Impl::bench_rooted, Impl::compute_rooted };
+	}
+}
+
+#endif
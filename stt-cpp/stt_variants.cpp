@@ -0,0 +1,14 @@
+#include "parse_input.h"
+#include "greedy_stt.h"
+#include "ltp_stt.h"
+#include "mtr_stt.h"
+
+/* All variants of all access implementations in one executable, selected with --variant=<name>
+ * (default: mtr6) or --variant=all. */
+int main( int argc, const char** argv ) {
+	std::vector<NamedImpl> impls;
+	mtr_stt::add_variants( impls );
+	greedy_stt::add_variants( impls );
+	ltp_stt::add_variants( impls );
+	return main_connectivity( argc, argv, impls, stt::handle_option );
+}
@@ -13,6 +13,10 @@ function check {
 	diff check/cmp0.txt check/cmp1.txt > /dev/null && echo "  Output identical" || { echo "  ERROR: Output differs"; exit 2; }
 }
 
+echo "Checking the STT operations beyond connectivity against a naive forest"
+./stt-cpp/bin/api_check || { echo "  ERROR: Check failed"; exit 2; }
+echo
+
 for f in data/con_*.txt; do
 	echo "Testing file: $f"
 	
@@ -46,3 +50,25 @@ for f in data/con_*.txt; do
 	fi
 	echo
 done
+
+# Rooted trees (LCA, evert and find-root queries), generated by generate_data.sh
+for f in data/lca_*.txt data/evert_*.txt; do
+	[ -f "$f" ] || continue
+	echo "Testing file: $f"
+	
+	echo "MTR-STT C++ optimized"
+	./stt-cpp/bin/mtr_stt compute $f > check/cmp0.txt
+	
+	echo "Greedy SplayTT C++ optimized"
+	./stt-cpp/bin/greedy_stt compute $f > check/cmp1.txt
+	check
+	
+	echo "LTP SplayTT C++ optimized"
+	./stt-cpp/bin/ltp_stt compute $f > check/cmp1.txt
+	check
+	
+	echo "dtree link-cut"
+	./dtree/dtree_queries compute $f > check/cmp1.txt
+	check
+	echo
+done